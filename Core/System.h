@@ -28,6 +28,7 @@
 #include <System/Object.h>
 #include <System/Type.h>
 #include <System/ObjectRef.h>
+#include <System/WeakObjectRef.h>
 #include <System/ObjectValue.h>
 #include <System/CopyableRef.h>
 #include <System/HashCodeHandler.h>
@@ -37,6 +38,8 @@
 
 #include <System/Console.h>
 #include <System/String.h>
+#include <System/StringBuilder.h>
+#include <System/StringView.h>
 #include <System/NameValue.h>
 #include <System/Exception.h>
 #include <System/Events.h>
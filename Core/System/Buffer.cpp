@@ -26,26 +26,19 @@
 #include <System/Buffer.h>
 #include <System/Threading/Synchro.h>
 
-#include <boost/thread/mutex.hpp>
-typedef boost::lock_guard<boost::mutex> lock_t;
-
 namespace System
 {
    namespace Private
    {
-      class Buffer : public System::Pimpl
+      class Buffer : public System::SharedPimpl
       {
       public:
          Buffer()
-            : referenceCount(0)
          {}
          Buffer(const byte_array& bytes)
-            : referenceCount(0)
-            , bytes(bytes)
+            : bytes(bytes)
          {}
 
-         size_t ReferenceCount() const;
-
          void Resize(size_t size)
          {
             bytes.resize(size);
@@ -66,7 +59,6 @@ namespace System
             return bytes;
          }
 
-         int referenceCount;
          Threading::Synchro syncRoot;
          byte_array bytes;
       };
@@ -87,76 +79,19 @@ namespace System
 
 using namespace System;
 
-static boost::mutex& m(){
-   static boost::mutex mtx;
-   return mtx;
-}
-#define LOCK lock_t l(m());
-#define PIMPL Private::Buffer* p(static_cast<Private::Buffer*>(this->p));
-
-size_t Private::Buffer::ReferenceCount() const
-{
-   LOCK
-   return referenceCount;
-}
+#define PIMPL Private::Buffer* p(this->p.Get());
 
 Buffer::Buffer()
   : p(new Private::Buffer)
-{
-   LOCK
-   PIMPL
-   p->referenceCount++;
-}
+{}
 
 Buffer::Buffer(const byte_array& bytes)
   : p(new Private::Buffer(bytes))
-{
-   LOCK
-   PIMPL
-   p->referenceCount++;
-}
-
-Buffer::~Buffer()
-{
-   LOCK
-   PIMPL
-   p->referenceCount--;
-   if(!p->referenceCount)
-      delete p;
-}
-
-Buffer::Buffer(const Buffer& src)
-  : p(src.p)
-{
-   LOCK
-   PIMPL
-   p->referenceCount++;
-}
-
-Buffer& Buffer::operator =(const Buffer& src)
-{
-   if(this==&src)
-      return *this;
-
-   LOCK
-   {
-      PIMPL
-      p->referenceCount--;
-      if(!p->referenceCount)
-         delete p;
-   }
-
-   this->p = src.p;
-   PIMPL
-   p->referenceCount++;
-
-   return *this;
-}
+{}
 
 size_t Buffer::HashCode() const
 {
-   PIMPL
-   return (size_t)p;
+   return p.HashCode();
 }
 
 void Buffer::Resize(size_t size)
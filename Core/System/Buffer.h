@@ -26,6 +26,7 @@
 #pragma once
 
 #include <System/Object.h>
+#include <System/SharedPimpl.h>
 
 #include <vector>
 
@@ -34,14 +35,13 @@ namespace System
    typedef unsigned char byte;
    typedef std::vector<byte> byte_array;
 
+   namespace Private { class Buffer; }
+
    class Buffer : public Object
    {
    public:
       Buffer();
       Buffer(const byte_array& bytes);
-      virtual ~Buffer();
-      Buffer(const Buffer& src);
-      Buffer& operator =(const Buffer& src);
 
       size_t HashCode() const;
 
@@ -52,6 +52,6 @@ namespace System
       byte_array ToArray() const;
 
    private:
-      Pimpl* p;
+      SharedHandle<Private::Buffer> p;
    };
 }
@@ -28,9 +28,11 @@
 #include <System/Collections/Generic/List.h>
 #include <System/Collections/Generic/Stack.h>
 #include <System/Collections/Generic/Queue.h>
+#include <System/Collections/Generic/ConcurrentQueue.h>
 #include <System/Collections/Generic/PriorityQueue.h>
 #include <System/Collections/Generic/Set.h>
 #include <System/Collections/Generic/Dictionary.h>
+#include <System/Collections/Generic/ConcurrentDictionary.h>
 
 #include <System/Collections/StringCollection.h>
 #include <System/Collections/NameValueCollection.h>
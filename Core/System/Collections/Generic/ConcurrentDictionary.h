@@ -0,0 +1,526 @@
+/**
+ * Copyright (c) 2011 Michel Foucault
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+#pragma once
+
+#include <System/Object.h>
+#include <System/SharedPimpl.h>
+#include <System/Memory/Epoch.h>
+#include <System/Collections/Generic/List.h>
+
+#include <cstddef>
+
+#include <boost/atomic.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/thread/locks.hpp>
+#include <boost/thread/mutex.hpp>
+
+namespace System
+{
+   namespace Collections
+   {
+      namespace Generic
+      {
+         namespace Detail
+         {
+            // Immutable once published: writers replace nodes instead of changing them
+            template<class K, class V>
+            class ConcurrentNode
+            {
+            public:
+               ConcurrentNode(const K& key, const V& value, size_t hash, ConcurrentNode* next)
+                  : key(key)
+                  , value(value)
+                  , hash(hash)
+                  , next(next)
+               {}
+
+               const K key;
+               const V value;
+               const size_t hash;
+               ConcurrentNode* const next;
+            };
+
+            // Power of two array of bucket chains. While it is resized, next is the larger table and
+            // each bucket holds Moved() once its nodes have been copied there.
+            template<class K, class V>
+            class ConcurrentTable
+            {
+            public:
+               typedef ConcurrentNode<K, V> Node;
+
+               explicit ConcurrentTable(size_t size)
+                  : mask(size-1)
+                  , buckets(new boost::atomic<Node*>[size])
+                  , next(NULL)
+                  , cursor(0)
+                  , migrated(0)
+               {
+                  for(size_t i=0; i<size; i++)
+                     buckets[i].store(NULL, boost::memory_order_relaxed);
+               }
+
+               // the nodes belong to the dictionary, see ConcurrentDictionaryState
+               ~ConcurrentTable()
+               {
+                  delete[] buckets;
+               }
+
+               size_t Size() const { return mask+1; }
+
+               boost::atomic<Node*>& Bucket(size_t hash) const { return buckets[hash&mask]; }
+
+               // never dereferenced, nodes are at least pointer aligned
+               static Node* Moved() { return reinterpret_cast<Node*>(1); }
+
+               const size_t mask;
+               boost::atomic<Node*>* const buckets;
+               boost::atomic<ConcurrentTable*> next;
+               boost::atomic<size_t> cursor;   // next bucket to hand to a helping writer
+               boost::atomic<size_t> migrated; // buckets moved to next
+
+            private:
+               ConcurrentTable(const ConcurrentTable&);
+               ConcurrentTable& operator =(const ConcurrentTable&);
+            };
+
+            // Readers walk the chains without locking, inside an epoch guard which keeps replaced nodes
+            // alive. Writers lock the stripe of the key's hash: a table is never smaller than the stripe
+            // count, so a stripe covers the same buckets in a table and in the next one, and a bucket can
+            // be moved by whoever holds its stripe. Writers each move a few buckets of a pending resize,
+            // readers follow Moved() to the next table meanwhile.
+            template<class K, class V>
+            class ConcurrentDictionaryState : public SharedPimpl
+            {
+            public:
+               typedef ConcurrentNode<K, V> Node;
+               typedef ConcurrentTable<K, V> Table;
+
+               ConcurrentDictionaryState()
+                  : root(new Table(stripeCount))
+               {
+                  for(size_t i=0; i<stripeCount; i++)
+                     stripes[i].count.store(0, boost::memory_order_relaxed);
+               }
+
+               // the last handle is gone, nobody reads any more
+               ~ConcurrentDictionaryState()
+               {
+                  Table* table(root.load(boost::memory_order_relaxed));
+                  Table* next(table->next.load(boost::memory_order_relaxed));
+                  Delete(table);
+                  if(next)
+                     Delete(next);
+               }
+
+               size_t Count() const
+               {
+                  size_t count(0);
+                  for(size_t i=0; i<stripeCount; i++)
+                     count += stripes[i].count.load(boost::memory_order_relaxed);
+                  return count;
+               }
+
+               bool TryGetValue(const K& key, V& value) const
+               {
+                  Memory::Epoch::Guard guard;
+                  const Node* node(Lookup(key, Hash(key)));
+                  if(!node)
+                     return false;
+
+                  value = node->value;
+                  return true;
+               }
+
+               bool TryAdd(const K& key, const V& value)
+               {
+                  Memory::Epoch::Guard guard;
+                  const size_t hash(Hash(key));
+                  Help();
+
+                  Stripe& stripe(StripeOf(hash));
+                  boost::lock_guard<boost::mutex> lock(stripe.mutex);
+                  boost::atomic<Node*>& bucket(WritableBucket(hash));
+                  Node* head(bucket.load(boost::memory_order_relaxed));
+                  if(Find(head, key, hash))
+                     return false;
+
+                  Insert(stripe, bucket, new Node(key, value, hash, head));
+                  return true;
+               }
+
+               V GetOrAdd(const K& key, const V& value)
+               {
+                  Memory::Epoch::Guard guard;
+                  const size_t hash(Hash(key));
+                  if(const Node* node = Lookup(key, hash))
+                     return node->value;
+
+                  Help();
+                  Stripe& stripe(StripeOf(hash));
+                  boost::lock_guard<boost::mutex> lock(stripe.mutex);
+                  boost::atomic<Node*>& bucket(WritableBucket(hash));
+                  Node* head(bucket.load(boost::memory_order_relaxed));
+                  if(const Node* node = Find(head, key, hash))
+                     return node->value;
+
+                  Insert(stripe, bucket, new Node(key, value, hash, head));
+                  return value;
+               }
+
+               template<class F>
+               V AddOrUpdate(const K& key, const V& addValue, F update)
+               {
+                  Memory::Epoch::Guard guard;
+                  const size_t hash(Hash(key));
+                  Help();
+
+                  Stripe& stripe(StripeOf(hash));
+                  boost::lock_guard<boost::mutex> lock(stripe.mutex);
+                  boost::atomic<Node*>& bucket(WritableBucket(hash));
+                  Node* head(bucket.load(boost::memory_order_relaxed));
+                  Node* node(Find(head, key, hash));
+                  if(!node)
+                  {
+                     Insert(stripe, bucket, new Node(key, addValue, hash, head));
+                     return addValue;
+                  }
+
+                  const V value(update(key, node->value));
+                  bucket.store(Copy(head, node, new Node(node->key, value, hash, node->next)), boost::memory_order_release);
+                  return value;
+               }
+
+               bool TryRemove(const K& key, V* value)
+               {
+                  Memory::Epoch::Guard guard;
+                  const size_t hash(Hash(key));
+                  Help();
+
+                  Stripe& stripe(StripeOf(hash));
+                  boost::lock_guard<boost::mutex> lock(stripe.mutex);
+                  boost::atomic<Node*>& bucket(WritableBucket(hash));
+                  Node* head(bucket.load(boost::memory_order_relaxed));
+                  Node* node(Find(head, key, hash));
+                  if(!node)
+                     return false;
+
+                  if(value)
+                     *value = node->value;
+                  bucket.store(Copy(head, node, node->next), boost::memory_order_release);
+                  stripe.count.store(stripe.count.load(boost::memory_order_relaxed)-1, boost::memory_order_relaxed);
+                  return true;
+               }
+
+               // takes every stripe, in order, and swaps in an empty table
+               void Clear()
+               {
+                  Memory::Epoch::Guard guard;
+                  for(size_t i=0; i<stripeCount; i++)
+                     stripes[i].mutex.lock();
+
+                  Table* table(root.load(boost::memory_order_relaxed));
+                  root.store(new Table(stripeCount), boost::memory_order_release);
+                  Table* next(table->next.load(boost::memory_order_relaxed));
+                  Retire(table);
+                  if(next)
+                     Retire(next);
+
+                  for(size_t i=0; i<stripeCount; i++)
+                  {
+                     stripes[i].count.store(0, boost::memory_order_relaxed);
+                     stripes[i].mutex.unlock();
+                  }
+               }
+
+               // a snapshot of each bucket in turn, keys changed meanwhile may be missed
+               Generic::List<K> AllKeys() const
+               {
+                  Memory::Epoch::Guard guard;
+                  Generic::List<K> keys;
+                  const Table* table(root.load(boost::memory_order_acquire));
+                  for(size_t i=0; i<table->Size(); i++)
+                     AddKeys(keys, table, i);
+                  return keys;
+               }
+
+            private:
+               static const size_t stripeCount = 64;
+               // buckets a writer moves for a pending resize before its own operation
+               static const size_t helpBatch = 8;
+
+               struct Stripe
+               {
+                  boost::mutex mutex;
+                  boost::atomic<size_t> count;
+                  char pad[64];
+               };
+
+               static size_t Hash(const K& key)
+               {
+                  boost::uint64_t hash(key.HashCode());
+                  hash ^= hash >> 33;
+                  hash *= 0xff51afd7ed558ccdULL;
+                  hash ^= hash >> 33;
+                  hash *= 0xc4ceb9fe1a85ec53ULL;
+                  hash ^= hash >> 33;
+                  return static_cast<size_t>(hash);
+               }
+
+               static Node* Find(Node* node, const K& key, size_t hash)
+               {
+                  for(; node; node=node->next)
+                  {
+                     if(node->hash==hash && node->key.Equals(key))
+                        return node;
+                  }
+                  return NULL;
+               }
+
+               Stripe& StripeOf(size_t hash)
+               {
+                  return stripes[hash&(stripeCount-1)];
+               }
+
+               // guard held
+               const Node* Lookup(const K& key, size_t hash) const
+               {
+                  const Table* table(root.load(boost::memory_order_acquire));
+                  for(;;)
+                  {
+                     Node* head(table->Bucket(hash).load(boost::memory_order_acquire));
+                     if(head!=Table::Moved())
+                        return Find(head, key, hash);
+                     table = table->next.load(boost::memory_order_acquire);
+                  }
+               }
+
+               // stripe held: the bucket of hash in the newest table, moved out of the older one first
+               boost::atomic<Node*>& WritableBucket(size_t hash)
+               {
+                  Table* table(root.load(boost::memory_order_acquire));
+                  for(;;)
+                  {
+                     Table* next(table->next.load(boost::memory_order_acquire));
+                     if(!next)
+                        return table->Bucket(hash);
+
+                     Migrate(table, hash&table->mask);
+                     table = next;
+                  }
+               }
+
+               // stripe held
+               void Insert(Stripe& stripe, boost::atomic<Node*>& bucket, Node* node)
+               {
+                  bucket.store(node, boost::memory_order_release);
+
+                  const size_t count(stripe.count.load(boost::memory_order_relaxed)+1);
+                  stripe.count.store(count, boost::memory_order_relaxed);
+
+                  // a stripe over its share of a load factor of 1 starts a resize, unless one is pending
+                  Table* table(root.load(boost::memory_order_relaxed));
+                  if(count*stripeCount>table->Size() && !table->next.load(boost::memory_order_relaxed))
+                  {
+                     Table* next(new Table(table->Size()*2));
+                     Table* none(NULL);
+                     if(!table->next.compare_exchange_strong(none, next))
+                        delete next;
+                  }
+               }
+
+               // the chain from head with target replaced by rest: the nodes before target are copied,
+               // they and target are retired
+               static Node* Copy(Node* node, Node* target, Node* rest)
+               {
+                  if(node==target)
+                  {
+                     Memory::Epoch::Retire(target);
+                     return rest;
+                  }
+
+                  Node* copy(new Node(node->key, node->value, node->hash, Copy(node->next, target, rest)));
+                  Memory::Epoch::Retire(node);
+                  return copy;
+               }
+
+               // move a few buckets of a pending resize, each under its own stripe
+               void Help()
+               {
+                  Table* table(root.load(boost::memory_order_acquire));
+                  if(!table->next.load(boost::memory_order_acquire))
+                     return;
+
+                  for(size_t i=0; i<helpBatch; i++)
+                  {
+                     const size_t index(table->cursor.fetch_add(1, boost::memory_order_relaxed));
+                     if(index>=table->Size())
+                        return;
+
+                     boost::lock_guard<boost::mutex> lock(stripes[index&(stripeCount-1)].mutex);
+                     // Clear() may have dropped the table meanwhile
+                     if(root.load(boost::memory_order_relaxed)!=table)
+                        return;
+                     Migrate(table, index);
+                  }
+               }
+
+               // stripe of index held: split the chain between the two buckets it maps to in the next table
+               void Migrate(Table* table, size_t index)
+               {
+                  Node* head(table->buckets[index].load(boost::memory_order_relaxed));
+                  if(head==Table::Moved())
+                     return;
+
+                  Table* next(table->next.load(boost::memory_order_relaxed));
+                  const size_t size(table->Size());
+                  Node* low(NULL);
+                  Node* high(NULL);
+                  for(Node* node=head; node; node=node->next)
+                  {
+                     Node*& chain(node->hash&size ? high : low);
+                     chain = new Node(node->key, node->value, node->hash, chain);
+                  }
+
+                  next->buckets[index].store(low, boost::memory_order_release);
+                  next->buckets[index+size].store(high, boost::memory_order_release);
+                  table->buckets[index].store(Table::Moved(), boost::memory_order_release);
+
+                  while(head)
+                  {
+                     Node* node(head);
+                     head = head->next;
+                     Memory::Epoch::Retire(node);
+                  }
+
+                  // the last bucket completes the resize
+                  if(table->migrated.fetch_add(1)+1==size)
+                  {
+                     root.store(next, boost::memory_order_release);
+                     Memory::Epoch::Retire(table);
+                  }
+               }
+
+               void AddKeys(Generic::List<K>& keys, const Table* table, size_t index) const
+               {
+                  const Node* node(table->buckets[index].load(boost::memory_order_acquire));
+                  if(node==Table::Moved())
+                  {
+                     const Table* next(table->next.load(boost::memory_order_acquire));
+                     AddKeys(keys, next, index);
+                     AddKeys(keys, next, index+table->Size());
+                     return;
+                  }
+
+                  for(; node; node=node->next)
+                     keys.Add(node->key);
+               }
+
+               static void Retire(Table* table)
+               {
+                  for(size_t i=0; i<table->Size(); i++)
+                  {
+                     Node* node(table->buckets[i].load(boost::memory_order_relaxed));
+                     if(node==Table::Moved())
+                        continue;
+                     while(node)
+                     {
+                        Node* next(node->next);
+                        Memory::Epoch::Retire(node);
+                        node = next;
+                     }
+                  }
+                  Memory::Epoch::Retire(table);
+               }
+
+               static void Delete(Table* table)
+               {
+                  for(size_t i=0; i<table->Size(); i++)
+                  {
+                     Node* node(table->buckets[i].load(boost::memory_order_relaxed));
+                     if(node==Table::Moved())
+                        continue;
+                     while(node)
+                     {
+                        Node* next(node->next);
+                        delete node;
+                        node = next;
+                     }
+                  }
+                  delete table;
+               }
+
+               boost::atomic<Table*> root;
+               Stripe stripes[stripeCount];
+            };
+         }
+
+         // Thread-safe dictionary for caches shared between threads. Lookups take no lock and never
+         // wait, writers lock one of 64 stripes, and growing the table is spread over later writes
+         // without stopping readers. K needs HashCode() and Equals(), as Dictionary's keys.
+         // Copies of a dictionary share its entries.
+         template<class K, class V>
+         class ConcurrentDictionary : public Object
+         {
+         public:
+            ConcurrentDictionary() : p(new Detail::ConcurrentDictionaryState<K, V>) {}
+
+            size_t HashCode() const { return p.HashCode(); }
+
+            // a snapshot, concurrent writes may change it at once
+            size_t Count() const { return p->Count(); }
+            bool Empty() const { return Count()==0; }
+
+            bool ContainsKey(const K& key) const
+            {
+               V value;
+               return p->TryGetValue(key, value);
+            }
+
+            bool TryGetValue(const K& key, V& value) const { return p->TryGetValue(key, value); }
+
+            // false when the key is already present
+            bool TryAdd(const K& key, const V& value) { return p->TryAdd(key, value); }
+
+            // the present value, or value once added
+            V GetOrAdd(const K& key, const V& value) { return p->GetOrAdd(key, value); }
+
+            // adds addValue, or replaces the present value with update(key, value); update runs under
+            // the key's stripe lock, it must not use the dictionary
+            template<class F>
+            V AddOrUpdate(const K& key, const V& addValue, F update) { return p->AddOrUpdate(key, addValue, update); }
+
+            bool TryRemove(const K& key) { return p->TryRemove(key, NULL); }
+            bool TryRemove(const K& key, V& value) { return p->TryRemove(key, &value); }
+
+            void Clear() { p->Clear(); }
+
+            List<K> AllKeys() const { return p->AllKeys(); }
+
+         private:
+            SharedHandle<Detail::ConcurrentDictionaryState<K, V> > p;
+         };
+      }
+   }
+}
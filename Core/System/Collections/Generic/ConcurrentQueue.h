@@ -0,0 +1,614 @@
+/**
+ * Copyright (c) 2011 Michel Foucault
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+#pragma once
+
+#include <System/Object.h>
+#include <System/SharedPimpl.h>
+#include <System/Threading/ResetEvent.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <new>
+#include <utility>
+#include <vector>
+
+#include <boost/atomic.hpp>
+#include <boost/thread/locks.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread_time.hpp>
+#include <boost/type_traits/aligned_storage.hpp>
+#include <boost/type_traits/alignment_of.hpp>
+#include <boost/type_traits/is_nothrow_move_assignable.hpp>
+#include <boost/type_traits/is_nothrow_move_constructible.hpp>
+
+namespace System
+{
+   namespace Collections
+   {
+      namespace Generic
+      {
+         namespace Detail
+         {
+            // keeps the producer and consumer positions on separate cache lines
+            struct CacheLinePad
+            {
+               char pad[64];
+            };
+
+            template<class T>
+            class ConcurrentItem
+            {
+            public:
+               T* Get() { return reinterpret_cast<T*>(&storage); }
+
+            private:
+               typename boost::aligned_storage<sizeof(T), boost::alignment_of<T>::value>::type storage;
+            };
+
+            // Vyukov's bounded MPMC ring: a slot's sequence equals the position of the producer whose turn
+            // it is, one more once the element is published, and position+capacity once it is consumed.
+            // A claimed position must be published and a consumed one released, so nothing may throw in
+            // between: elements are built before their position is claimed, and moved in and out of the
+            // slots, which T must do without throwing.
+            template<class T>
+            class ConcurrentRing
+            {
+               static_assert(boost::is_nothrow_move_constructible<T>::value && boost::is_nothrow_move_assignable<T>::value,
+                             "ConcurrentQueue elements must move without throwing");
+
+            public:
+               explicit ConcurrentRing(size_t capacity)
+                  : mask(capacity-1)
+                  , slots(capacity)
+                  , enqueuePos(0)
+                  , dequeuePos(0)
+               {
+                  for(size_t i=0; i<capacity; i++)
+                     slots[i].sequence.store(i, boost::memory_order_relaxed);
+               }
+
+               // only destroyed once every producer and consumer is gone
+               ~ConcurrentRing()
+               {
+                  const size_t end(enqueuePos.load(boost::memory_order_relaxed));
+                  for(size_t pos=dequeuePos.load(boost::memory_order_relaxed); pos!=end; pos++)
+                     slots[pos&mask].item.Get()->~T();
+               }
+
+               size_t Capacity() const { return mask+1; }
+
+               // positions claimed, so elements being written or read are counted too
+               size_t Count() const
+               {
+                  const size_t dequeued(dequeuePos.load(boost::memory_order_relaxed));
+                  const size_t enqueued(enqueuePos.load(boost::memory_order_relaxed));
+                  return enqueued>dequeued ? std::min(enqueued-dequeued, Capacity()) : 0;
+               }
+
+               // the copy is made before claiming a position, t is left as it was when the ring is full
+               bool TryPush(const T& t)
+               {
+                  T item(t);
+                  return TryPush(std::move(item));
+               }
+
+               // t is only moved from once a position is claimed
+               bool TryPush(T&& t)
+               {
+                  size_t pos(enqueuePos.load(boost::memory_order_relaxed));
+                  for(;;)
+                  {
+                     Slot& slot(slots[pos&mask]);
+                     const ptrdiff_t diff(static_cast<ptrdiff_t>(slot.sequence.load(boost::memory_order_acquire)-pos));
+                     if(diff==0 && enqueuePos.compare_exchange_weak(pos, pos+1, boost::memory_order_relaxed))
+                        break;
+                     if(diff<0)
+                        return false;
+                     if(diff>0)
+                        pos = enqueuePos.load(boost::memory_order_relaxed);
+                  }
+
+                  Slot& slot(slots[pos&mask]);
+                  new(slot.item.Get()) T(std::move(t));
+                  slot.sequence.store(pos+1, boost::memory_order_release);
+                  return true;
+               }
+
+               bool TryPop(T& t)
+               {
+                  size_t pos;
+                  Slot* slot(Claim(pos));
+                  if(!slot)
+                     return false;
+
+                  t = std::move(*slot->item.Get());
+                  Release(*slot, pos);
+                  return true;
+               }
+
+               // at most Capacity() elements, room for them is reserved before any is claimed
+               size_t TryPopRange(std::vector<T>& output, size_t maxCount)
+               {
+                  maxCount = std::min(maxCount, Capacity());
+                  output.reserve(output.size()+maxCount);
+
+                  size_t count(0);
+                  size_t pos;
+                  while(count<maxCount)
+                  {
+                     Slot* slot(Claim(pos));
+                     if(!slot)
+                        break;
+
+                     output.push_back(std::move(*slot->item.Get()));
+                     Release(*slot, pos);
+                     count++;
+                  }
+                  return count;
+               }
+
+            private:
+               struct Slot
+               {
+                  boost::atomic<size_t> sequence;
+                  ConcurrentItem<T> item;
+               };
+
+               Slot* Claim(size_t& pos)
+               {
+                  pos = dequeuePos.load(boost::memory_order_relaxed);
+                  for(;;)
+                  {
+                     Slot& slot(slots[pos&mask]);
+                     const ptrdiff_t diff(static_cast<ptrdiff_t>(slot.sequence.load(boost::memory_order_acquire)-(pos+1)));
+                     if(diff==0 && dequeuePos.compare_exchange_weak(pos, pos+1, boost::memory_order_relaxed))
+                        return &slot;
+                     if(diff<0)
+                        return NULL;
+                     if(diff>0)
+                        pos = dequeuePos.load(boost::memory_order_relaxed);
+                  }
+               }
+
+               void Release(Slot& slot, size_t pos)
+               {
+                  slot.item.Get()->~T();
+                  slot.sequence.store(pos+mask+1, boost::memory_order_release);
+               }
+
+               const size_t mask;
+               std::vector<Slot> slots;
+               CacheLinePad pad0;
+               boost::atomic<size_t> enqueuePos;
+               CacheLinePad pad1;
+               boost::atomic<size_t> dequeuePos;
+               CacheLinePad pad2;
+            };
+
+            // Unbounded list of fixed size segments, producers take the tail lock and consumers the head
+            // lock so both ends only meet on a segment's published count
+            template<class T>
+            class ConcurrentSegments
+            {
+            public:
+               ConcurrentSegments()
+                  : head(new Segment)
+                  , headIndex(0)
+                  , tail(head)
+                  , pushed(0)
+                  , popped(0)
+               {}
+
+               ~ConcurrentSegments()
+               {
+                  while(head)
+                  {
+                     const size_t published(head->published.load(boost::memory_order_relaxed));
+                     for(; headIndex<published; headIndex++)
+                        head->items[headIndex].Get()->~T();
+
+                     Segment* next(head->next.load(boost::memory_order_relaxed));
+                     delete head;
+                     head = next;
+                     headIndex = 0;
+                  }
+               }
+
+               size_t Count() const
+               {
+                  const size_t out(popped.load(boost::memory_order_relaxed));
+                  const size_t in(pushed.load(boost::memory_order_relaxed));
+                  return in>out ? in-out : 0;
+               }
+
+               template<class U>
+               void Push(U&& t)
+               {
+                  boost::lock_guard<boost::mutex> lock(tailMutex);
+                  Append(std::forward<U>(t));
+               }
+
+               template<class I>
+               void PushRange(I first, I last)
+               {
+                  boost::lock_guard<boost::mutex> lock(tailMutex);
+                  while(first!=last)
+                     Append(*first++);
+               }
+
+               bool TryPop(T& t)
+               {
+                  boost::lock_guard<boost::mutex> lock(headMutex);
+                  T* item(Front());
+                  if(!item)
+                     return false;
+
+                  t = std::move(*item);
+                  PopFront(item);
+                  return true;
+               }
+
+               size_t TryPopRange(std::vector<T>& output, size_t maxCount)
+               {
+                  boost::lock_guard<boost::mutex> lock(headMutex);
+                  size_t count(0);
+                  while(count<maxCount)
+                  {
+                     T* item(Front());
+                     if(!item)
+                        break;
+
+                     output.push_back(std::move(*item));
+                     PopFront(item);
+                     count++;
+                  }
+                  return count;
+               }
+
+            private:
+               static const size_t segmentSize = 256;
+
+               struct Segment
+               {
+                  Segment() : published(0), next(NULL) {}
+
+                  boost::atomic<size_t> published;
+                  boost::atomic<Segment*> next;
+                  ConcurrentItem<T> items[segmentSize];
+               };
+
+               // tail lock held
+               template<class U>
+               void Append(U&& t)
+               {
+                  size_t index(tail->published.load(boost::memory_order_relaxed));
+                  if(index==segmentSize)
+                  {
+                     // the head side frees a full segment once it sees the next one, never touch it again
+                     Segment* segment(new Segment);
+                     tail->next.store(segment, boost::memory_order_release);
+                     tail = segment;
+                     index = 0;
+                  }
+
+                  new(tail->items[index].Get()) T(std::forward<U>(t));
+                  tail->published.store(index+1, boost::memory_order_release);
+                  pushed.store(pushed.load(boost::memory_order_relaxed)+1, boost::memory_order_relaxed);
+               }
+
+               // head lock held, NULL when empty
+               T* Front()
+               {
+                  if(headIndex==segmentSize)
+                  {
+                     Segment* next(head->next.load(boost::memory_order_acquire));
+                     if(!next)
+                        return NULL;
+                     delete head;
+                     head = next;
+                     headIndex = 0;
+                  }
+
+                  if(headIndex==head->published.load(boost::memory_order_acquire))
+                     return NULL;
+                  return head->items[headIndex].Get();
+               }
+
+               void PopFront(T* item)
+               {
+                  item->~T();
+                  headIndex++;
+                  popped.store(popped.load(boost::memory_order_relaxed)+1, boost::memory_order_relaxed);
+               }
+
+               boost::mutex headMutex;
+               Segment* head;
+               size_t headIndex;
+               CacheLinePad pad0;
+               boost::mutex tailMutex;
+               Segment* tail;
+               CacheLinePad pad1;
+               boost::atomic<size_t> pushed;
+               CacheLinePad pad2;
+               boost::atomic<size_t> popped;
+            };
+
+            // A ring or a segment list, with the events blocking producers on a full ring and consumers on
+            // an empty queue. Threads count themselves as waiting before their last try, and the other side
+            // checks that count after each change, so a wakeup cannot be missed.
+            template<class T>
+            class ConcurrentQueueState : public SharedPimpl
+            {
+            public:
+               explicit ConcurrentQueueState(size_t capacity)
+                  : ring(capacity ? new ConcurrentRing<T>(RoundCapacity(capacity)) : NULL)
+                  , segments(capacity ? NULL : new ConcurrentSegments<T>)
+                  , consumersWaiting(0)
+                  , producersWaiting(0)
+               {}
+
+               ~ConcurrentQueueState()
+               {
+                  delete ring;
+                  delete segments;
+               }
+
+               size_t Capacity() const { return ring ? ring->Capacity() : 0; }
+               size_t Count() const { return ring ? ring->Count() : segments->Count(); }
+
+               template<class U>
+               bool TryPush(U&& t)
+               {
+                  if(!ring)
+                     segments->Push(std::forward<U>(t));
+                  else if(!ring->TryPush(std::forward<U>(t)))
+                     return false;
+
+                  Pushed();
+                  return true;
+               }
+
+               template<class I>
+               size_t TryPushRange(I first, I last)
+               {
+                  size_t count(0);
+                  if(!ring)
+                  {
+                     segments->PushRange(first, last);
+                     count = std::distance(first, last);
+                  }
+                  else
+                  {
+                     while(first!=last && ring->TryPush(*first))
+                     {
+                        ++first;
+                        count++;
+                     }
+                  }
+
+                  if(count)
+                     Pushed();
+                  return count;
+               }
+
+               bool TryPop(T& t)
+               {
+                  if(!(ring ? ring->TryPop(t) : segments->TryPop(t)))
+                     return false;
+
+                  Popped();
+                  return true;
+               }
+
+               size_t TryPopRange(std::vector<T>& output, size_t maxCount)
+               {
+                  const size_t count(ring ? ring->TryPopRange(output, maxCount) : segments->TryPopRange(output, maxCount));
+                  if(count)
+                     Popped();
+                  return count;
+               }
+
+               template<class U>
+               void Push(U&& t)
+               {
+                  while(!TryPush(std::forward<U>(t)))
+                     Wait(false, NULL);
+
+                  if(ring && ring->Count()<ring->Capacity())
+                     Chain(false);
+               }
+
+               template<class I>
+               void PushRange(I first, I last)
+               {
+                  for(;;)
+                  {
+                     std::advance(first, TryPushRange(first, last));
+                     if(first==last)
+                        break;
+                     Wait(false, NULL);
+                  }
+
+                  if(ring && ring->Count()<ring->Capacity())
+                     Chain(false);
+               }
+
+               // blocks until an element comes, or until the deadline when one is given
+               bool Pop(T& t, const boost::system_time* deadline)
+               {
+                  while(!TryPop(t))
+                  {
+                     if(!Wait(true, deadline))
+                        return TryPop(t);
+                  }
+
+                  if(Count())
+                     Chain(true);
+                  return true;
+               }
+
+               size_t PopRange(std::vector<T>& output, size_t maxCount)
+               {
+                  size_t count(0);
+                  while(maxCount && !(count = TryPopRange(output, maxCount)))
+                     Wait(true, NULL);
+
+                  if(Count())
+                     Chain(true);
+                  return count;
+               }
+
+            private:
+               static size_t RoundCapacity(size_t capacity)
+               {
+                  // a single slot cannot tell a published element from a free turn
+                  size_t rounded(2);
+                  while(rounded<capacity)
+                     rounded *= 2;
+                  return rounded;
+               }
+
+               void Pushed()
+               {
+                  boost::atomic_thread_fence(boost::memory_order_seq_cst);
+                  if(consumersWaiting.load(boost::memory_order_relaxed))
+                     notEmpty.NotifyAll();
+               }
+
+               void Popped()
+               {
+                  if(!ring)
+                     return;
+
+                  boost::atomic_thread_fence(boost::memory_order_seq_cst);
+                  if(producersWaiting.load(boost::memory_order_relaxed))
+                     notFull.NotifyAll();
+               }
+
+               // a thread that got its turn after a Reset() may have swallowed a wakeup meant for others
+               void Chain(bool consumer)
+               {
+                  boost::atomic_thread_fence(boost::memory_order_seq_cst);
+                  if((consumer ? consumersWaiting : producersWaiting).load(boost::memory_order_relaxed))
+                     (consumer ? notEmpty : notFull).NotifyAll();
+               }
+
+               // sleep until the other side changes the queue, false once the deadline has passed;
+               // the caller tries again either way
+               bool Wait(bool consumer, const boost::system_time* deadline)
+               {
+                  boost::atomic<int>& waiting(consumer ? consumersWaiting : producersWaiting);
+                  Threading::ResetEvent& event(consumer ? notEmpty : notFull);
+
+                  waiting.fetch_add(1);
+                  event.Reset();
+                  boost::atomic_thread_fence(boost::memory_order_seq_cst);
+
+                  bool signaled(true);
+                  if(consumer ? Count()==0 : Count()==ring->Capacity())
+                  {
+                     if(!deadline)
+                        event.WaitOne();
+                     else
+                     {
+                        const boost::system_time now(boost::get_system_time());
+                        signaled = now<*deadline && event.WaitOne((*deadline-now).total_milliseconds());
+                     }
+                  }
+
+                  waiting.fetch_sub(1);
+                  return signaled;
+               }
+
+               ConcurrentRing<T>* ring;
+               ConcurrentSegments<T>* segments;
+               boost::atomic<int> consumersWaiting;
+               boost::atomic<int> producersWaiting;
+               Threading::ResetEvent notEmpty;
+               Threading::ResetEvent notFull;
+            };
+         }
+
+         // Thread-safe FIFO queue. Bounded queues are a lock-free ring whose capacity is rounded up to a
+         // power of two, the default unbounded queue is a list of segments with one lock per end.
+         // T must move without throwing, a throwing copy leaves the queue as it was. Copies of a queue
+         // share its elements.
+         template<class T>
+         class ConcurrentQueue : public Object
+         {
+         public:
+            ConcurrentQueue() : p(new Detail::ConcurrentQueueState<T>(0)) {}
+            explicit ConcurrentQueue(size_t capacity) : p(new Detail::ConcurrentQueueState<T>(capacity)) {}
+
+            size_t HashCode() const { return p.HashCode(); }
+
+            // 0 for an unbounded queue
+            size_t Capacity() const { return p->Capacity(); }
+
+            // a snapshot, concurrent operations may change it at once
+            size_t Count() const { return p->Count(); }
+            bool Empty() const { return Count()==0; }
+
+            // false when a bounded queue is full
+            bool TryEnqueue(const T& t) { return p->TryPush(t); }
+            bool TryEnqueue(T&& t) { return p->TryPush(std::move(t)); }
+
+            // blocks while a bounded queue is full
+            void Enqueue(const T& t) { p->Push(t); }
+            void Enqueue(T&& t) { p->Push(std::move(t)); }
+
+            // enqueues from the front of items until a bounded queue is full, returns how many were
+            size_t TryEnqueueRange(const std::vector<T>& items) { return p->TryPushRange(items.begin(), items.end()); }
+            void EnqueueRange(const std::vector<T>& items) { p->PushRange(items.begin(), items.end()); }
+
+            bool TryDequeue(T& t) { return p->TryPop(t); }
+
+            // waits up to msecs for an element
+            bool TryDequeue(T& t, size_t msecs)
+            {
+               const boost::system_time deadline(boost::get_system_time()+boost::posix_time::milliseconds(msecs));
+               return p->Pop(t, &deadline);
+            }
+
+            // blocks until an element is available
+            T Dequeue()
+            {
+               T t;
+               p->Pop(t, NULL);
+               return t;
+            }
+
+            // append up to maxCount elements to items, returns how many were dequeued
+            size_t TryDequeueRange(std::vector<T>& items, size_t maxCount) { return p->TryPopRange(items, maxCount); }
+
+            // as TryDequeueRange, but first blocks until there is at least one element
+            size_t DequeueRange(std::vector<T>& items, size_t maxCount) { return p->PopRange(items, maxCount); }
+
+         private:
+            SharedHandle<Detail::ConcurrentQueueState<T> > p;
+         };
+      }
+   }
+}
@@ -27,10 +27,8 @@
 #include <System/SimpleObject.h>
 #include <System/Exception.h>
 
-#include <map>
-
-#include <boost/thread/mutex.hpp>
-typedef boost::lock_guard<boost::mutex> lock_t;
+#include <stdint.h>
+#include <vector>
 
 namespace System
 {
@@ -42,52 +40,40 @@ namespace System
          {
             namespace Private
             {
-               struct ObjectPair : public System::Pimpl
-               {
-               public:
-                  ObjectPair(ObjectRef Key, ObjectRef Value)
-                     : Key(Key)
-                     , Value(Value)
-                  {}
-
-                  size_t ReferenceCount() const { return 0; }
-
-                  ObjectRef Key;
-                  ObjectRef Value;
-               };
-
-               typedef std::map<size_t, ObjectPair> ObjectMap;
-
-               class Dictionary : public System::Pimpl
+               // Robin Hood hashing: an entry displaces any entry sitting closer to its home bucket,
+               // so probe lengths stay short and even at 7/8 load, and a lookup stops as soon as it
+               // meets an entry closer to home than itself. Removal shifts the following entries
+               // back instead of leaving tombstones. The probe only reads the bucket array, the
+               // keys are compared once the stored hash matches.
+               class Dictionary : public System::SharedPimpl
                {
                public:
                   Dictionary()
-                     : referenceCount(0)
+                     : count(0)
                   {}
 
-                  size_t ReferenceCount() const;
-
                   bool Empty() const
                   {
-                     return objectMap.empty();
+                     return !count;
                   }
 
                   size_t Count() const
                   {
-                     return objectMap.size();
+                     return count;
                   }
 
-                  bool Contains(const ObjectRef& key) const
+                  bool Contains(const Object& key) const
                   {
-                     return objectMap.find(key.HashCode())!=objectMap.end();
+                     return Find(key)!=npos;
                   }
 
-                  ObjectRef operator[](const ObjectRef& key) const
+                  ObjectRef operator[](const Object& key) const
                   {
-                     if(!Contains(key))
+                     const size_t index(Find(key));
+                     if(index==npos)
                         throw ObjectNotFoundException();
 
-                     return objectMap.find(key.HashCode())->second.Value;
+                     return entries[index].value;
                   }
 
                   void Add(const ObjectRef& key, const ObjectRef& value)
@@ -95,45 +81,148 @@ namespace System
                      if(Contains(key))
                         throw ObjectPresentException();
 
-                     objectMap.insert(std::make_pair(key.HashCode(), Private::ObjectPair(key, value)));
+                     if((count+1)*8>buckets.size()*7)
+                        Rehash(buckets.empty() ? 16 : 2*buckets.size());
+
+                     Entry entry(key, value);
+                     Insert(Mix(key.HashCode()), entry);
+                     count++;
                   }
 
-                  void Remove(const ObjectRef& key)
+                  void Remove(const Object& key)
                   {
-                     if(!Contains(key))
+                     size_t index(Find(key));
+                     if(index==npos)
                         throw ObjectNotFoundException();
 
-                     objectMap.erase(objectMap.find(key.HashCode()));
+                     const size_t mask(buckets.size()-1);
+                     for(size_t next=(index+1)&mask; buckets[next].distance>1; index=next, next=(next+1)&mask)
+                     {
+                        buckets[index].distance = buckets[next].distance-1;
+                        buckets[index].hash = buckets[next].hash;
+                        entries[index] = std::move(entries[next]);
+                     }
+                     buckets[index] = Bucket();
+                     entries[index] = Entry();
+                     count--;
                   }
 
                   void Clear()
                   {
-                     objectMap.clear();
+                     buckets.clear();
+                     entries.clear();
+                     count = 0;
                   }
 
-                  List AllKeys() const
+                  Detail::List AllKeys() const
                   {
-                     List ret;
-
-                     Private::ObjectMap::const_iterator it(objectMap.begin());
-                     while(it!=objectMap.end())
+                     Detail::List ret;
+                     for(size_t i=0; i<buckets.size(); i++)
                      {
-                        const ObjectRef& obj((*it++).second.Key);
-                        ret.Add(obj);
+                        if(buckets[i].distance)
+                           ret.Add(entries[i].key);
                      }
-
                      return ret;
                   }
 
-                  ObjectRef& operator[](const ObjectRef& key)
+                  ObjectRef& operator[](const Object& key)
                   {
-                     if(!Contains(key))
+                     const size_t index(Find(key));
+                     if(index==npos)
                         throw ObjectNotFoundException();
-                     return (*objectMap.find(key.HashCode())).second.Value;
+
+                     return entries[index].value;
                   }
 
-                  int referenceCount;
-                  Private::ObjectMap objectMap;
+               private:
+                  static const size_t npos = static_cast<size_t>(-1);
+
+                  struct Bucket
+                  {
+                     Bucket() : distance(0), hash(0) {}
+
+                     uint32_t distance;   // 1 + the distance from the home bucket, 0 when empty
+                     uint32_t hash;       // the mixed hash, it picks the home bucket and rehashing needs no HashCode() call
+                  };
+
+                  struct Entry
+                  {
+                     Entry() {}
+                     Entry(const ObjectRef& key, const ObjectRef& value) : key(key), value(value) {}
+
+                     ObjectRef key;
+                     ObjectRef value;
+                  };
+
+                  // many hash codes are pimpl addresses, their low bits are all alike
+                  static uint32_t Mix(uint64_t hash)
+                  {
+                     hash ^= hash >> 33;
+                     hash *= 0xff51afd7ed558ccdULL;
+                     hash ^= hash >> 33;
+                     hash *= 0xc4ceb9fe1a85ec53ULL;
+                     hash ^= hash >> 33;
+                     return static_cast<uint32_t>(hash);
+                  }
+
+                  size_t Find(const Object& key) const
+                  {
+                     if(!count)
+                        return npos;
+
+                     const uint32_t hash(Mix(key.HashCode()));
+                     const size_t mask(buckets.size()-1);
+                     for(size_t index=hash&mask, distance=1; ; index=(index+1)&mask, distance++)
+                     {
+                        const Bucket& bucket(buckets[index]);
+                        if(bucket.distance<distance)
+                           return npos;
+                        if(bucket.hash==hash && key.Equals(entries[index].key.Get()))
+                           return index;
+                     }
+                  }
+
+                  // the key is known to be absent and a bucket to be free, entry is moved from
+                  void Insert(uint32_t hash, Entry& entry)
+                  {
+                     Bucket bucket;
+                     bucket.distance = 1;
+                     bucket.hash = hash;
+
+                     const size_t mask(buckets.size()-1);
+                     for(size_t index=hash&mask; ; index=(index+1)&mask, bucket.distance++)
+                     {
+                        if(!buckets[index].distance)
+                        {
+                           buckets[index] = bucket;
+                           entries[index] = std::move(entry);
+                           return;
+                        }
+                        if(buckets[index].distance<bucket.distance)
+                        {
+                           std::swap(buckets[index], bucket);
+                           std::swap(entries[index], entry);
+                        }
+                     }
+                  }
+
+                  void Rehash(size_t size)
+                  {
+                     std::vector<Bucket> previousBuckets(size);
+                     std::vector<Entry> previousEntries(size);
+                     buckets.swap(previousBuckets);
+                     entries.swap(previousEntries);
+
+                     for(size_t i=0; i<previousBuckets.size(); i++)
+                     {
+                        if(previousBuckets[i].distance)
+                           Insert(previousBuckets[i].hash, previousEntries[i]);
+                     }
+                  }
+
+                  std::vector<Bucket> buckets;
+                  std::vector<Entry> entries;
+                  size_t count;
                };
             }
          }
@@ -144,68 +233,15 @@ namespace System
 using namespace System;
 using namespace System::Collections::Generic::Detail;
 
-static boost::mutex& m(){
-   static boost::mutex mtx;
-   return mtx;
-}
-#define LOCK lock_t l(m());
-#define PIMPL Private::Dictionary* p(static_cast<Private::Dictionary*>(this->p));
-
-size_t Private::Dictionary::ReferenceCount() const
-{
-   LOCK
-   return referenceCount;
-}
+#define PIMPL Private::Dictionary* p(this->p.Get());
 
 Dictionary::Dictionary()
   : p(new Private::Dictionary)
-{
-   LOCK
-   PIMPL
-   p->referenceCount++;
-}
-
-Dictionary::~Dictionary()
-{
-   LOCK
-   PIMPL
-   p->referenceCount--;
-   if(!p->referenceCount)
-      delete p;
-}
-
-Dictionary::Dictionary(const Dictionary& src)
-  : p(src.p)
-{
-   LOCK
-   PIMPL
-   p->referenceCount++;
-}
-
-Dictionary& Dictionary::operator =(const Dictionary& src)
-{
-   if(this==&src)
-      return *this;
-
-   LOCK
-   {
-      PIMPL
-      p->referenceCount--;
-      if(!p->referenceCount)
-         delete p;
-   }
-
-   this->p = src.p;
-   PIMPL
-   p->referenceCount++;
-
-   return *this;
-}
+{}
 
 size_t Dictionary::HashCode() const
 {
-   PIMPL
-   return (size_t)p;
+   return p.HashCode();
 }
 
 bool Dictionary::Empty() const
@@ -220,13 +256,13 @@ size_t Dictionary::Count() const
    return p->Count();
 }
 
-bool Dictionary::Contains(const ObjectRef& key) const
+bool Dictionary::Contains(const Object& key) const
 {
    PIMPL
    return p->Contains(key);
 }
 
-ObjectRef Dictionary::operator[](const ObjectRef& key) const
+ObjectRef Dictionary::operator[](const Object& key) const
 {
    PIMPL
    return (*p)[key];
@@ -239,7 +275,7 @@ void Dictionary::Add(const ObjectRef& key, const ObjectRef& value)
    p->Add(key, value);
 }
 
-void Dictionary::Remove(const ObjectRef& key)
+void Dictionary::Remove(const Object& key)
 {
    PIMPL
    p->Remove(key);
@@ -251,7 +287,7 @@ void Dictionary::Clear()
    p->Clear();
 }
 
-ObjectRef& Dictionary::operator[](const ObjectRef& key)
+ObjectRef& Dictionary::operator[](const Object& key)
 {
    PIMPL
    return (*p)[key];
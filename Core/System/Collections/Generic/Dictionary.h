@@ -26,6 +26,7 @@
 #pragma once
 
 #include <System/Object.h>
+#include <System/SharedPimpl.h>
 #include <System/ObjectRef.h>
 #include <System/Collections/Generic/List.h>
 
@@ -37,31 +38,33 @@ namespace System
       {
          namespace Detail
          {
+            namespace Private { class Dictionary; }
+
+            // Open addressing hash table, keys are told apart with Object::Equals. Lookups take the
+            // key object itself, an ObjectRef works as well. References returned by operator[] stay
+            // valid until the next Add or Remove.
             class Dictionary : public Object
             {
             public:
                Dictionary();
-               virtual ~Dictionary();
-               Dictionary(const Dictionary& src);
-               Dictionary& operator =(const Dictionary& src);
 
                virtual size_t HashCode() const;
 
                bool Empty() const;
                size_t Count() const;
-               bool Contains(const ObjectRef& key) const;
-               ObjectRef operator[](const ObjectRef& key) const;
+               bool Contains(const Object& key) const;
+               ObjectRef operator[](const Object& key) const;
 
                void Add(const ObjectRef& key, const ObjectRef& value);
-               void Remove(const ObjectRef& key);
+               void Remove(const Object& key);
                void Clear();
 
-               ObjectRef& operator[](const ObjectRef& key);
+               ObjectRef& operator[](const Object& key);
 
                List AllKeys() const;
 
             private:
-               Pimpl* p;
+               SharedHandle<Private::Dictionary> p;
             };
          }
 
@@ -81,26 +84,26 @@ namespace System
                return dictionary.Count();
             }
 
-            bool Contains(const K k) const
+            bool Contains(const K& k) const
             {
-               return dictionary.Contains(ObjectRef::Create(k));
+               return dictionary.Contains(k);
             }
 
-            V operator[](const K k) const
+            V operator[](const K& k) const
             {
-               ObjectRef obj(dictionary[ObjectRef::Create(k)]);
+               ObjectRef obj(dictionary[k]);
 
                return obj.Get<V>();
             }
 
-            void Add(const K k, const V v)
+            void Add(const K& k, const V& v)
             {
-               dictionary.Add(ObjectRef::Create(k), ObjectRef::Create(v));
+               dictionary.Add(ObjectRef::Make<K>(k), ObjectRef::Make<V>(v));
             }
 
-            void Remove(const K k)
+            void Remove(const K& k)
             {
-               dictionary.Remove(ObjectRef::Create(k));
+               dictionary.Remove(k);
             }
 
             void Clear()
@@ -115,9 +118,8 @@ namespace System
                ObjectCollection::iterator it = objects.begin();
                while(it != objects.end())
                {
-                  ObjectRef& obj(*it++);
-                  if(obj.IsTypeOf<K>())
-                     ret.Add(obj.Get<K>());
+                  if(const K* key = (it++)->As<K>())
+                     ret.Add(*key);
                }
 
                return ret;
@@ -29,9 +29,7 @@
 #include <exception>
 #include <vector>
 #include <algorithm>
-
-#include <boost/thread/mutex.hpp>
-typedef boost::lock_guard<boost::mutex> lock_t;
+#include <utility>
 
 namespace System
 {
@@ -43,15 +41,12 @@ namespace System
          {
             namespace Private
             {
-               class List : public System::Pimpl
+               class List : public System::SharedPimpl
                {
                public:
                   List()
-                     : referenceCount(0)
                   {}
 
-                  size_t ReferenceCount() const;
-
                   bool Empty() const
                   {
                      return objects.empty();
@@ -67,9 +62,14 @@ namespace System
                      objects.push_back(object);
                   }
 
+                  void Add(ObjectRef&& object)
+                  {
+                     objects.push_back(std::move(object));
+                  }
+
                   void AddRange(const System::Collections::Generic::Detail::List& newObjects)
                   {
-                     if(this==newObjects.p)
+                     if(this==newObjects.p.Get())
                      {
                         System::Collections::Generic::Detail::List newList;
                         newList.AddRange(newObjects);
@@ -77,7 +77,7 @@ namespace System
                         return;
                      }
 
-                     List* np = static_cast<List*>(newObjects.p);
+                     List* np = newObjects.p.Get();
                      const ObjectCollection& objs(np->objects);
                      ObjectCollection::const_iterator it(objs.begin());
                      while(it!=objs.end())
@@ -86,7 +86,7 @@ namespace System
                      }
                   }
 
-                  const System::Object& At(size_t index)
+                  const ObjectRef& At(size_t index)
                   {
                      if(index>=objects.size())
                         throw OutOfBoundException();
@@ -126,7 +126,6 @@ namespace System
                      }
                   }
 
-                  int referenceCount;
                   ObjectCollection objects;
                };
             }
@@ -138,63 +137,11 @@ namespace System
 using namespace System;
 using namespace System::Collections::Generic::Detail;
 
-static boost::mutex& m(){
-   static boost::mutex mtx;
-   return mtx;
-}
-#define LOCK lock_t l(m());
-#define PIMPL Private::List* p(static_cast<Private::List*>(this->p));
-
-size_t Private::List::ReferenceCount() const
-{
-   LOCK
-   return referenceCount;
-}
+#define PIMPL Private::List* p(this->p.Get());
 
 List::List()
   : p(new Private::List)
-{
-   LOCK
-   PIMPL
-   p->referenceCount++;
-}
-
-List::~List()
-{
-   LOCK
-   PIMPL
-   p->referenceCount--;
-   if(!p->referenceCount)
-      delete p;
-}
-
-List::List(const List& src)
-  : p(src.p)
-{
-   LOCK
-   PIMPL
-   p->referenceCount++;
-}
-
-List& List::operator =(const List& src)
-{
-   if(this==&src)
-      return *this;
-
-   LOCK
-   {
-      PIMPL
-      p->referenceCount--;
-      if(!p->referenceCount)
-         delete p;
-   }
-
-   this->p = src.p;
-   PIMPL
-   p->referenceCount++;
-
-   return *this;
-}
+{}
 
 bool List::Empty() const
 {
@@ -214,13 +161,19 @@ void List::Add(const ObjectRef& object)
    p->Add(object);
 }
 
+void List::Add(ObjectRef&& object)
+{
+   PIMPL
+   p->Add(std::move(object));
+}
+
 void List::AddRange(const List& objects)
 {
    PIMPL
    p->AddRange(objects);
 }
 
-const System::Object& List::At(size_t index) const
+const ObjectRef& List::At(size_t index) const
 {
    PIMPL
    return p->At(index);
@@ -245,14 +198,21 @@ void List::Reverse()
 }
 
 size_t List::HashCode() const
+{
+   return p.HashCode();
+}
+
+System::Collections::ObjectCollection List::ToArray() const &
 {
    PIMPL
-   return (size_t)p;
+   return p->objects;
 }
 
-System::Collections::ObjectCollection List::ToArray() const
+System::Collections::ObjectCollection List::ToArray() &&
 {
    PIMPL
+   if(p->ReferenceCount()==1)
+      return std::move(p->objects);
    return p->objects;
 }
 
@@ -26,13 +26,24 @@
 #pragma once
 
 #include <System/Object.h>
+#include <System/SharedPimpl.h>
 #include <System/ObjectRef.h>
 #include <System/Collections/Generic/ListDelegate.h>
+#include <System/Exception.h>
 
+#include <algorithm>
+#include <exception>
+#include <utility>
 #include <vector>
 
+#include <boost/type_traits/is_arithmetic.hpp>
+#include <boost/type_traits/is_enum.hpp>
+
 namespace System
 {
+   class Guid;
+   class NameValue;
+
    namespace Collections
    {
       typedef std::vector<ObjectRef> ObjectCollection;
@@ -41,20 +52,20 @@ namespace System
       {
          namespace Detail
          {
+            namespace Private { class List; }
+
             class List : public Object
             {
             public:
                List();
-               virtual ~List();
-               List(const List& src);
-               List& operator =(const List& src);
 
                virtual bool Empty() const;
                virtual size_t Count() const;
                void Add(const ObjectRef& object);
+               void Add(ObjectRef&& object);
                void AddRange(const List& objects);
 
-               const System::Object& At(size_t index) const;
+               const ObjectRef& At(size_t index) const;
 
                void RemoveAt(size_t index);
                void Clear();
@@ -62,15 +73,169 @@ namespace System
 
                virtual size_t HashCode() const;
 
-               ObjectCollection ToArray() const;
+               ObjectCollection ToArray() const &;
+               // a temporary list holding its elements alone hands them over without copying
+               ObjectCollection ToArray() &&;
 
                void ForEach(ObjectDelegate& delegate);
 
             public:
-               Pimpl* p;
+               SharedHandle<Private::List> p;
+            };
+
+            // Whether List<T> stores its elements inline rather than boxed one by one in an ObjectRef.
+            // Opt-in: scalars and the framework's value types below. Objects are polymorphic, a vector
+            // of a base class would slice derived elements, so other types stay boxed.
+            template<class T>
+            struct IsValueType
+            {
+               static const bool value = boost::is_arithmetic<T>::value || boost::is_enum<T>::value;
+            };
+
+            template<> struct IsValueType<String> { static const bool value = true; };
+            template<> struct IsValueType<Guid> { static const bool value = true; };
+            template<> struct IsValueType<NameValue> { static const bool value = true; };
+
+            // Adapts a functor on T& to the boxed list's ObjectDelegate
+            template<class T, class F>
+            class ListFunctor : public ListDelegate<T>
+            {
+               F& f;
+            public:
+               ListFunctor(F& f) : f(f) {}
+               virtual void operator()(T& t) { f(t); }
+            };
+
+            template<class T, bool Unboxed = IsValueType<T>::value>
+            class ListStorage;
+
+            // One ObjectRef per element, see Detail::List
+            template<class T>
+            class ListStorage<T, false>
+            {
+            public:
+               size_t HashCode() const { return list.HashCode(); }
+               bool Empty() const { return list.Empty(); }
+               size_t Count() const { return list.Count(); }
+
+               void Add(const T& t) { list.Add(ObjectRef::Make<T>(t)); }
+               void Add(T&& t) { list.Add(ObjectRef::Make<T>(std::move(t))); }
+               void AddRange(const ListStorage& storage) { list.AddRange(storage.list); }
+
+               const T& At(size_t index) const { return list.At(index).template Get<T>(); }
+
+               void RemoveAt(size_t index) { list.RemoveAt(index); }
+               void Clear() { list.Clear(); }
+               void Reverse() { list.Reverse(); }
+
+               std::vector<T> ToArray() const
+               {
+                  std::vector<T> ret;
+
+                  const size_t count(list.Count());
+                  ret.reserve(count);
+                  for(size_t i=0; i<count; i++)
+                  {
+                     if(const T* item = list.At(i).template As<T>())
+                        ret.push_back(*item);
+                  }
+
+                  return ret;
+               }
+
+               void ForEach(ListDelegate<T>& delegate) { list.ForEach(delegate); }
+
+               template<class F>
+               void ForEach(F& f)
+               {
+                  ListFunctor<T, F> func(f);
+                  list.ForEach(func);
+               }
+
+            private:
+               List list;
+            };
+
+            template<class T>
+            class ValueList : public SharedPimpl
+            {
+            public:
+               std::vector<T> items;
+            };
+
+            // Elements stored contiguously in a vector shared by the list copies
+            template<class T>
+            class ListStorage<T, true>
+            {
+            public:
+               ListStorage() : p(new ValueList<T>) {}
+
+               size_t HashCode() const { return p.HashCode(); }
+               bool Empty() const { return p->items.empty(); }
+               size_t Count() const { return p->items.size(); }
+
+               void Add(const T& t) { p->items.push_back(t); }
+               void Add(T&& t) { p->items.push_back(std::move(t)); }
+
+               void AddRange(const ListStorage& storage)
+               {
+                  std::vector<T>& items(p->items);
+                  const std::vector<T>& newItems(storage.p->items);
+                  if(&items==&newItems)
+                  {
+                     const size_t count(items.size());
+                     items.reserve(count*2);
+                     for(size_t i=0; i<count; i++)
+                        items.push_back(items[i]);
+                     return;
+                  }
+                  items.insert(items.end(), newItems.begin(), newItems.end());
+               }
+
+               const T& At(size_t index) const
+               {
+                  const std::vector<T>& items(p->items);
+                  if(index>=items.size())
+                     throw OutOfBoundException();
+                  return items[index];
+               }
+
+               void RemoveAt(size_t index)
+               {
+                  std::vector<T>& items(p->items);
+                  if(index>=items.size())
+                     throw OutOfBoundException();
+                  items.erase(items.begin()+index);
+               }
+
+               void Clear() { p->items.clear(); }
+               void Reverse() { std::reverse(p->items.begin(), p->items.end()); }
+
+               std::vector<T> ToArray() const { return p->items; }
+
+               // same contract as Detail::List::ForEach, an element throwing does not stop the walk
+               template<class F>
+               void ForEach(F& f)
+               {
+                  std::vector<T>& items(p->items);
+                  for(size_t i=0; i<items.size(); i++)
+                  {
+                     try {
+                        f(items[i]);
+                     }
+                     catch(System::Exception&){}
+                     catch(std::exception&){}
+                     catch(...){}
+                  }
+               }
+
+            private:
+               SharedHandle<ValueList<T> > p;
             };
          }
 
+         // Value types are stored contiguously, other types boxed, see Detail::IsValueType.
+         // Copies of a list share its elements.
          template<class T>
          class List : public Object
          {
@@ -89,7 +254,12 @@ namespace System
 
             void Add(const T& t)
             {
-               list.Add(ObjectRef::Create(t));
+               list.Add(t);
+            }
+
+            void Add(T&& t)
+            {
+               list.Add(std::move(t));
             }
 
             void AddRange(const List<T>& coll)
@@ -99,8 +269,7 @@ namespace System
 
             T At(size_t index) const
             {
-                const ObjectRef& ret(dynamic_cast<const ObjectRef&>(list.At(index)));
-                return ret.Get<T>();
+                return list.At(index);
             }
 
             T operator[](size_t index) const
@@ -116,25 +285,13 @@ namespace System
 
             std::vector<T> ToArray() const
             {
-               std::vector<T> ret;
-
-               ObjectCollection objects = list.ToArray();
-               ObjectCollection::iterator it = objects.begin();
-               while(it != objects.end())
-               {
-                  ObjectRef& obj(*it++);
-                  if(obj.IsTypeOf<T>())
-                     ret.push_back(obj.Get<T>());
-               }
-
-               return ret;
+               return list.ToArray();
             }
 
             template<class F>
             void ForEach(F f)
             {
-               ListFunctor<F> func(f);
-               list.ForEach(func);
+               list.ForEach(f);
             }
 
             void ForEach(ListDelegate<T>& delegate)
@@ -143,15 +300,7 @@ namespace System
             }
 
          private:
-            Detail::List list;
-            template<class F>
-            class ListFunctor : public ListDelegate<T>
-            {
-               F f;
-            public:
-               ListFunctor(F f) : f(f) {}
-               virtual void operator()(T& t) { f(t); }
-            };
+            Detail::ListStorage<T> list;
          };
       }
    }
@@ -43,8 +43,8 @@ namespace System
          protected:
             virtual void operator()(ObjectRef& object)
             {
-               if(object.IsTypeOf<T>())
-                  (*this)(object.Get<T>());
+               if(T* t = object.As<T>())
+                  (*this)(*t);
             }
          };
       }
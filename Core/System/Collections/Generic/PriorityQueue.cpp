@@ -29,9 +29,6 @@
 #include <queue>
 #include <functional>
 
-#include <boost/thread/mutex.hpp>
-typedef boost::lock_guard<boost::mutex> lock_t;
-
 namespace System
 {
    namespace Collections
@@ -73,15 +70,12 @@ namespace System
 
                typedef std::priority_queue<PriorityItem, std::vector<PriorityItem>, PriorityItemComparer> ObjectQueue;
 
-               class PriorityQueue : public System::Pimpl
+               class PriorityQueue : public System::SharedPimpl
                {
                public:
                   PriorityQueue()
-                     : referenceCount(0)
                   {}
 
-                  size_t ReferenceCount() const;
-
                   bool Empty() const { return queue.empty(); }
                   size_t Count() const { return queue.size(); }
 
@@ -103,8 +97,6 @@ namespace System
                         queue.pop();
                   }
 
-                  int referenceCount;
-
                   ObjectQueue queue;
                };
             }
@@ -116,68 +108,15 @@ namespace System
 using namespace System;
 using namespace System::Collections::Generic::Detail;
 
-static boost::mutex& m(){
-   static boost::mutex mtx;
-   return mtx;
-}
-#define LOCK lock_t l(m());
-#define PIMPL Private::PriorityQueue* p(static_cast<Private::PriorityQueue*>(this->p));
-
-size_t Private::PriorityQueue::ReferenceCount() const
-{
-   LOCK
-   return referenceCount;
-}
+#define PIMPL Private::PriorityQueue* p(this->p.Get());
 
 PriorityQueue::PriorityQueue()
   : p(new Private::PriorityQueue)
-{
-   LOCK
-   PIMPL
-   p->referenceCount++;
-}
-
-PriorityQueue::~PriorityQueue()
-{
-   LOCK
-   PIMPL
-   p->referenceCount--;
-   if(!p->referenceCount)
-      delete p;
-}
-
-PriorityQueue::PriorityQueue(const PriorityQueue& src)
-  : p(src.p)
-{
-   LOCK
-   PIMPL
-   p->referenceCount++;
-}
-
-PriorityQueue& PriorityQueue::operator =(const PriorityQueue& src)
-{
-   if(this==&src)
-      return *this;
-
-   LOCK
-   {
-      PIMPL
-      p->referenceCount--;
-      if(!p->referenceCount)
-         delete p;
-   }
-
-   this->p = src.p;
-   PIMPL
-   p->referenceCount++;
-
-   return *this;
-}
+{}
 
 size_t PriorityQueue::HashCode() const
 {
-   PIMPL
-   return (size_t)p;
+   return p.HashCode();
 }
 
 bool PriorityQueue::Empty() const
@@ -26,6 +26,7 @@
 #pragma once
 
 #include <System/Object.h>
+#include <System/SharedPimpl.h>
 #include <System/ObjectRef.h>
 #include <System/Collections/Generic/List.h>
 
@@ -37,13 +38,12 @@ namespace System
       {
          namespace Detail
          {
+            namespace Private { class PriorityQueue; }
+
             class PriorityQueue : public Object
             {
             public:
                PriorityQueue();
-               virtual ~PriorityQueue();
-               PriorityQueue(const PriorityQueue& src);
-               PriorityQueue& operator =(const PriorityQueue& src);
 
                size_t HashCode() const;
 
@@ -56,7 +56,7 @@ namespace System
                void Clear();
 
             private:
-               Pimpl* p;
+               SharedHandle<Private::PriorityQueue> p;
             };
          }
 
@@ -70,7 +70,7 @@ namespace System
             size_t Count() const { return queue.Count(); }
 
             void Enqueue(T t) { Enqueue(t, 1); }
-            void Enqueue(T t, int priority) { queue.Enqueue(ObjectRef(new T(t)), priority); }
+            void Enqueue(T t, int priority) { queue.Enqueue(ObjectRef::Make<T>(t), priority); }
 
             T Dequeue()
             {
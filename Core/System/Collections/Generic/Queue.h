@@ -26,7 +26,14 @@
 #pragma once
 
 #include <System/SimpleObject.h>
-#include <System/Collections/Generic/List.h>
+#include <System/SharedPimpl.h>
+#include <System/Exception.h>
+
+#include <algorithm>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
 
 namespace System
 {
@@ -34,33 +41,199 @@ namespace System
    {
       namespace Generic
       {
+         namespace Detail
+         {
+            // Growable circular buffer: the capacity is a power of two so positions wrap with a mask,
+            // growing unwraps the elements to the front of the new storage
+            template<class T>
+            class QueueBuffer : public SharedPimpl
+            {
+            public:
+               QueueBuffer()
+                  : items(NULL)
+                  , capacity(0)
+                  , head(0)
+                  , count(0)
+               {}
+
+               ~QueueBuffer()
+               {
+                  Clear();
+                  if(items)
+                     allocator.deallocate(items, capacity);
+               }
+
+               size_t Count() const { return count; }
+
+               T& At(size_t index) const
+               {
+                  return items[(head+index)&(capacity-1)];
+               }
+
+               void Reserve(size_t needed)
+               {
+                  if(needed<=capacity)
+                     return;
+
+                  size_t newCapacity(capacity ? capacity*2 : 16);
+                  while(newCapacity<needed)
+                     newCapacity *= 2;
+
+                  // elements are copied unless their move cannot throw, and the old ones are only
+                  // destroyed once all are in place: a throwing copy leaves the queue as it was
+                  T* newItems(allocator.allocate(newCapacity));
+                  size_t constructed(0);
+                  try
+                  {
+                     for(; constructed<count; constructed++)
+                        new(newItems+constructed) T(std::move_if_noexcept(At(constructed)));
+                  }
+                  catch(...)
+                  {
+                     for(size_t i=0; i<constructed; i++)
+                        newItems[i].~T();
+                     allocator.deallocate(newItems, newCapacity);
+                     throw;
+                  }
+
+                  for(size_t i=0; i<count; i++)
+                     At(i).~T();
+                  if(items)
+                     allocator.deallocate(items, capacity);
+
+                  items = newItems;
+                  capacity = newCapacity;
+                  head = 0;
+               }
+
+               template<class U>
+               void Push(U&& t)
+               {
+                  Reserve(count+1);
+                  new(&At(count)) T(std::forward<U>(t));
+                  count++;
+               }
+
+               T Pop()
+               {
+                  T& front(At(0));
+                  T ret(std::move(front));
+                  front.~T();
+                  head = (head+1)&(capacity-1);
+                  count--;
+                  return ret;
+               }
+
+               // move up to maxCount elements from the front to the end of output, a span at a time
+               size_t PopRange(std::vector<T>& output, size_t maxCount)
+               {
+                  const size_t total(std::min(maxCount, count));
+                  output.reserve(output.size()+total);
+
+                  size_t left(total);
+                  while(left)
+                  {
+                     const size_t span(std::min(left, capacity-head));
+                     T* first(items+head);
+                     output.insert(output.end(), std::make_move_iterator(first), std::make_move_iterator(first+span));
+                     for(size_t i=0; i<span; i++)
+                        first[i].~T();
+
+                     head = (head+span)&(capacity-1);
+                     count -= span;
+                     left -= span;
+                  }
+                  return total;
+               }
+
+               void Clear()
+               {
+                  for(size_t i=0; i<count; i++)
+                     At(i).~T();
+                  head = 0;
+                  count = 0;
+               }
+
+            private:
+               std::allocator<T> allocator;
+               T* items;
+               size_t capacity;
+               size_t head;
+               size_t count;
+            };
+         }
+
+         // FIFO queue on a circular buffer, Enqueue and Dequeue are amortized O(1).
+         // Copies of a queue share its elements.
          template<class T>
          class Queue : public SimpleObject
          {
          public:
-            bool Empty() const { return list.Empty(); }
-            size_t Count() const { return list.Count(); }
+            Queue() : p(new Detail::QueueBuffer<T>) {}
 
-            void Enqueue(T t)
+            bool Empty() const { return p->Count()==0; }
+            size_t Count() const { return p->Count(); }
+
+            void Enqueue(const T& t)
+            {
+               p->Push(t);
+            }
+
+            void Enqueue(T&& t)
+            {
+               p->Push(std::move(t));
+            }
+
+            template<class I>
+            void EnqueueRange(I first, I last)
+            {
+               while(first!=last)
+                  p->Push(*first++);
+            }
+
+            void EnqueueRange(const std::vector<T>& items)
             {
-               list.Add(t);
+               p->Reserve(p->Count()+items.size());
+               EnqueueRange(items.begin(), items.end());
             }
 
+            // throws OutOfBoundException when the queue is empty
             T Dequeue()
             {
-               T ret(list.At(0));
-               list.RemoveAt(0);
+               if(Empty())
+                  throw OutOfBoundException();
+               return p->Pop();
+            }
+
+            bool TryDequeue(T& t)
+            {
+               if(Empty())
+                  return false;
+               t = p->Pop();
+               return true;
+            }
 
-               return ret;
+            // append up to maxCount elements to items, returns how many were dequeued
+            size_t DequeueRange(std::vector<T>& items, size_t maxCount)
+            {
+               return p->PopRange(items, maxCount);
+            }
+
+            // the next element to dequeue, throws OutOfBoundException when the queue is empty
+            T Peek() const
+            {
+               if(Empty())
+                  throw OutOfBoundException();
+               return p->At(0);
             }
 
             void Clear()
             {
-               list.Clear();
+               p->Clear();
             }
 
          private:
-            List<T> list;
+            SharedHandle<Detail::QueueBuffer<T> > p;
          };
       }
    }
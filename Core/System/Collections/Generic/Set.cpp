@@ -24,12 +24,7 @@
  */
 
 #include <System/Collections/Generic/Set.h>
-#include <System/Exception.h>
-
-#include <map>
-
-#include <boost/thread/mutex.hpp>
-typedef boost::lock_guard<boost::mutex> lock_t;
+#include <System/Collections/Generic/Dictionary.h>
 
 namespace System
 {
@@ -41,70 +36,49 @@ namespace System
          {
             namespace Private
             {
-               typedef std::map<size_t, ObjectRef> ObjectMap;
-
-               class Set : public System::Pimpl
+               // keys of the Robin Hood table with no value, told apart with Object::Equals
+               class Set : public System::SharedPimpl
                {
                public:
                   Set()
-                     : referenceCount(0)
                   {}
 
-                  size_t ReferenceCount() const;
-
                   bool Empty() const
                   {
-                     return objectMap.empty();
+                     return table.Empty();
                   }
 
                   size_t Count() const
                   {
-                     return objectMap.size();
+                     return table.Count();
                   }
 
-                  bool Contains(const ObjectRef& object) const
+                  bool Contains(const Object& object) const
                   {
-                     const Object& obj(object);
-                     return objectMap.find(obj.HashCode())!=objectMap.end();
+                     return table.Contains(object);
                   }
 
                   void Add(const ObjectRef& object)
                   {
-                     if(Contains(object))
-                        throw Exception();
-
-                     objectMap.insert(std::make_pair(object.HashCode(), object));
+                     table.Add(object, ObjectRef());
                   }
 
-                  void Remove(const ObjectRef& object)
+                  void Remove(const Object& object)
                   {
-                     if(!Contains(object))
-                        throw Exception();
-
-                     objectMap.erase(objectMap.find(object));
+                     table.Remove(object);
                   }
 
                   void Clear()
                   {
-                     objectMap.clear();
+                     table.Clear();
                   }
 
-                  List ToList() const
+                  Detail::List ToList() const
                   {
-                     List ret;
-
-                     Private::ObjectMap::const_iterator it(objectMap.begin());
-                     while(it!=objectMap.end())
-                     {
-                        const ObjectRef& obj((*it++).second);
-                        ret.Add(obj);
-                     }
-
-                     return ret;
+                     return table.AllKeys();
                   }
 
-                  int referenceCount;
-                  Private::ObjectMap objectMap;
+                  Detail::Dictionary table;
                };
             }
          }
@@ -115,68 +89,15 @@ namespace System
 using namespace System;
 using namespace System::Collections::Generic::Detail;
 
-static boost::mutex& m(){
-   static boost::mutex mtx;
-   return mtx;
-}
-#define LOCK lock_t l(m());
-#define PIMPL Private::Set* p(static_cast<Private::Set*>(this->p));
-
-size_t Private::Set::ReferenceCount() const
-{
-   LOCK
-   return referenceCount;
-}
+#define PIMPL Private::Set* p(this->p.Get());
 
 Set::Set()
   : p(new Private::Set)
-{
-   LOCK
-   PIMPL
-   p->referenceCount++;
-}
-
-Set::~Set()
-{
-   LOCK
-   PIMPL
-   p->referenceCount--;
-   if(!p->referenceCount)
-      delete p;
-}
-
-Set::Set(const Set& src)
-  : p(src.p)
-{
-   LOCK
-   PIMPL
-   p->referenceCount++;
-}
-
-Set& Set::operator =(const Set& src)
-{
-   if(this==&src)
-      return *this;
-
-   LOCK
-   {
-      PIMPL
-      p->referenceCount--;
-      if(!p->referenceCount)
-         delete p;
-   }
-
-   this->p = src.p;
-   PIMPL
-   p->referenceCount++;
-
-   return *this;
-}
+{}
 
 size_t Set::HashCode() const
 {
-   PIMPL
-   return (size_t)p;
+   return p.HashCode();
 }
 
 bool Set::Empty() const
@@ -191,7 +112,7 @@ size_t Set::Count() const
    return p->Count();
 }
 
-bool Set::Contains(const ObjectRef& object) const
+bool Set::Contains(const Object& object) const
 {
    PIMPL
    return p->Contains(object);
@@ -203,7 +124,7 @@ void Set::Add(const ObjectRef& object)
    p->Add(object);
 }
 
-void Set::Remove(const ObjectRef& object)
+void Set::Remove(const Object& object)
 {
    PIMPL
    p->Remove(object);
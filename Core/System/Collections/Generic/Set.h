@@ -26,6 +26,7 @@
 #pragma once
 
 #include <System/Object.h>
+#include <System/SharedPimpl.h>
 #include <System/ObjectRef.h>
 #include <System/Collections/Generic/List.h>
 
@@ -37,27 +38,28 @@ namespace System
       {
          namespace Detail
          {
+            namespace Private { class Set; }
+
+            // Keys are told apart with Object::Equals, as Dictionary's. Add throws ObjectPresentException
+            // and Remove ObjectNotFoundException.
             class Set : public Object
             {
             public:
                Set();
-               virtual ~Set();
-               Set(const Set& src);
-               Set& operator =(const Set& src);
 
                virtual size_t HashCode() const;
 
                bool Empty() const;
                size_t Count() const;
-               bool Contains(const ObjectRef& object) const;
+               bool Contains(const Object& object) const;
                void Add(const ObjectRef& object);
-               void Remove(const ObjectRef& object);
+               void Remove(const Object& object);
                void Clear();
 
                List ToList() const;
 
             private:
-               Pimpl* p;
+               SharedHandle<Private::Set> p;
             };
          }
 
@@ -82,17 +84,17 @@ namespace System
 
             bool Contains(const T t) const
             {
-               return set.Contains(ObjectRef::Create(t));
+               return set.Contains(t);
             }
 
             void Add(const T t)
             {
-               set.Add(ObjectRef::Create(t));
+               set.Add(ObjectRef::Make<T>(t));
             }
 
             void Remove(const T t)
             {
-               set.Remove(ObjectRef::Create(t));
+               set.Remove(t);
             }
 
             void Clear()
@@ -108,9 +110,8 @@ namespace System
                ObjectCollection::iterator it = objects.begin();
                while(it != objects.end())
                {
-                  ObjectRef& obj(*it++);
-                  if(obj.IsTypeOf<T>())
-                     ret.Add(obj.Get<T>());
+                  if(const T* item = (it++)->As<T>())
+                     ret.Add(*item);
                }
 
                return ret;
@@ -35,6 +35,8 @@ namespace System
       class StringCollection : public Generic::List<String>
       {
       public:
+         using Generic::List<String>::Add;
+
          void Add(const std::string& string)
          {
             Generic::List<String>::Add(String(string));
@@ -27,40 +27,459 @@
 #include <System/Exception.h>
 #include <System/Threading/Synchro.h>
 
+#include <boost/atomic.hpp>
+#include <boost/bind.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+
+#include <cstdlib>
 #include <iostream>
+#include <vector>
 
 namespace System
 {
    namespace Private
    {
+      // leaked, the asynchronous writer still uses it while statics are destroyed at exit
       Threading::Synchro SyncRoot()
       {
-         static Threading::Synchro syncRoot;
-         return syncRoot;
+         static Threading::Synchro* syncRoot(new Threading::Synchro);
+         return *syncRoot;
+      }
+
+      void WriteOut(const std::string& text)
+      {
+         Threading::Locker lock(SyncRoot());
+         std::cout.write(text.data(), text.size());
+      }
+
+      // Bounded queue after Vyukov: a slot's sequence tells whether it is free for the write at
+      // its position or holds it. The writer thread consumes, under Overwrite producers also
+      // consume the oldest write to make room. Positions below writtenPos are out or discarded.
+      class AsyncWriter
+      {
+      public:
+         AsyncWriter(size_t capacity, Console::OverflowPolicy policy)
+            : mask(capacity-1)
+            , slots(capacity)
+            , policy(policy)
+            , enqueuePos(0)
+            , dequeuePos(0)
+            , writtenPos(0)
+            , dropped(0)
+            , flushPos(0)
+            , sleeping(false)
+            , stopping(false)
+            , closed(false)
+            , users(0)
+         {
+            for(size_t i=0; i<capacity; i++)
+               slots[i].sequence.store(i, boost::memory_order_relaxed);
+            thread = boost::thread(boost::bind(&AsyncWriter::Run, this));
+         }
+
+         // false when the writer is stopping and text was not queued, the caller writes it out
+         bool Push(const std::string& text)
+         {
+            while(!TryEnqueue(text))
+            {
+               if(policy==Console::Drop)
+               {
+                  dropped++;
+                  return true;
+               }
+               if(policy==Console::Overwrite)
+               {
+                  if(TryDequeue(NULL))
+                     dropped++;
+                  continue;
+               }
+
+               boost::unique_lock<boost::mutex> lock(mutex);
+               // Stop() does not wait for room, the writer is about to be drained
+               if(stopping)
+                  return false;
+               wake.notify_one();
+               progress.timed_wait(lock, boost::posix_time::milliseconds(1));
+            }
+
+            // pairs with the fence in Run(): either the writer sees the write or we see it sleeping
+            boost::atomic_thread_fence(boost::memory_order_seq_cst);
+            if(sleeping.load(boost::memory_order_relaxed))
+            {
+               boost::lock_guard<boost::mutex> lock(mutex);
+               wake.notify_one();
+            }
+            return true;
+         }
+
+         void Flush()
+         {
+            const size_t target(enqueuePos.load());
+            boost::unique_lock<boost::mutex> lock(mutex);
+            if(flushPos.load()<target)
+               flushPos.store(target);
+            wake.notify_one();
+            while(writtenPos.load()<target)
+               progress.timed_wait(lock, boost::posix_time::milliseconds(10));
+         }
+
+         // New writes go straight to the console from here on, waits on a full queue give up
+         void Stop()
+         {
+            boost::lock_guard<boost::mutex> lock(mutex);
+            stopping = true;
+            progress.notify_all();
+         }
+
+         // Drains the queue and joins the writer, once no producer can enqueue anymore
+         void Close()
+         {
+            {
+               boost::lock_guard<boost::mutex> lock(mutex);
+               closed = true;
+               wake.notify_one();
+            }
+            thread.join();
+         }
+
+         size_t Dropped() const
+         {
+            return dropped.load();
+         }
+
+         // callers holding this writer, see WriterRef
+         boost::atomic<size_t> users;
+
+      private:
+         struct Slot
+         {
+            boost::atomic<size_t> sequence;
+            std::string text;
+         };
+
+         // largest batch handed to a single write
+         static const size_t batchSize = 64<<10;
+         // slots give back larger buffers after use, so memory stays bounded by the capacity
+         static const size_t slotRetain = 4<<10;
+
+         bool TryEnqueue(const std::string& text)
+         {
+            size_t pos(enqueuePos.load(boost::memory_order_relaxed));
+            for(;;)
+            {
+               Slot& slot(slots[pos&mask]);
+               const ptrdiff_t diff(static_cast<ptrdiff_t>(slot.sequence.load(boost::memory_order_acquire)-pos));
+               if(diff==0 && enqueuePos.compare_exchange_weak(pos, pos+1, boost::memory_order_relaxed))
+                  break;
+               if(diff<0)
+                  return false;
+               if(diff>0)
+                  pos = enqueuePos.load(boost::memory_order_relaxed);
+            }
+
+            Slot& slot(slots[pos&mask]);
+            slot.text.assign(text);
+            slot.sequence.store(pos+1, boost::memory_order_release);
+            return true;
+         }
+
+         // appends the oldest write to out, or discards it when out is NULL
+         bool TryDequeue(std::string* out)
+         {
+            size_t pos(dequeuePos.load(boost::memory_order_relaxed));
+            for(;;)
+            {
+               Slot& slot(slots[pos&mask]);
+               const ptrdiff_t diff(static_cast<ptrdiff_t>(slot.sequence.load(boost::memory_order_acquire)-(pos+1)));
+               if(diff==0 && dequeuePos.compare_exchange_weak(pos, pos+1, boost::memory_order_relaxed))
+                  break;
+               if(diff<0)
+                  return false;
+               if(diff>0)
+                  pos = dequeuePos.load(boost::memory_order_relaxed);
+            }
+
+            Slot& slot(slots[pos&mask]);
+            if(out)
+               out->append(slot.text);
+            if(slot.text.capacity()>slotRetain)
+               std::string().swap(slot.text);
+            slot.sequence.store(pos+mask+1, boost::memory_order_release);
+            return true;
+         }
+
+         bool Empty() const
+         {
+            const size_t pos(dequeuePos.load(boost::memory_order_relaxed));
+            return slots[pos&mask].sequence.load(boost::memory_order_acquire)!=pos+1;
+         }
+
+         void Run()
+         {
+            std::string batch;
+            for(;;)
+            {
+               while(batch.size()<batchSize && TryDequeue(&batch))
+                  ;
+
+               // every position below dequeuePos is now in the batch or was discarded by a producer
+               const size_t done(dequeuePos.load());
+               if(!batch.empty())
+               {
+                  WriteOut(batch);
+                  batch.clear();
+               }
+
+               // a burst reaches the stream in large writes, it is flushed once the queue runs idle
+               // or a Flush() waits on it
+               const size_t flushTarget(flushPos.load());
+               const bool flush(Empty() || (flushTarget>writtenPos.load() && done>=flushTarget));
+               if(flush)
+               {
+                  Threading::Locker lock(SyncRoot());
+                  std::cout.flush();
+               }
+
+               boost::unique_lock<boost::mutex> lock(mutex);
+               if(flush)
+               {
+                  writtenPos.store(done);
+                  progress.notify_all();
+               }
+               if(!Empty())
+                  continue;
+               if(closed)
+               {
+                  Threading::Locker lock(SyncRoot());
+                  std::cout.flush();
+                  break;
+               }
+
+               sleeping.store(true, boost::memory_order_relaxed);
+               boost::atomic_thread_fence(boost::memory_order_seq_cst);
+               if(Empty())
+                  wake.timed_wait(lock, boost::posix_time::milliseconds(100));
+               sleeping.store(false, boost::memory_order_relaxed);
+            }
+         }
+
+         const size_t mask;
+         std::vector<Slot> slots;
+         const Console::OverflowPolicy policy;
+
+         boost::atomic<size_t> enqueuePos;
+         boost::atomic<size_t> dequeuePos;
+         boost::atomic<size_t> writtenPos;
+         boost::atomic<size_t> dropped;
+         boost::atomic<size_t> flushPos;
+
+         // sleeping and the condition variables are only touched on the slow paths
+         boost::atomic<bool> sleeping;
+         boost::atomic<bool> stopping;
+         bool closed;
+         boost::mutex mutex;
+         boost::condition_variable wake;
+         boost::condition_variable progress;
+         boost::thread thread;
+      };
+
+      boost::atomic<AsyncWriter*> asyncWriter(NULL);
+      // callers between loading asyncWriter and counting themselves as users of what they found
+      boost::atomic<size_t> asyncLoads(0);
+
+      // Holds the current writer, if any, until released. StopAsync() deletes a writer only once
+      // no user is left, so users may find it stopping but never freed. Callers finding no writer
+      // or done with it do not hold up the drain.
+      class WriterRef
+      {
+      public:
+         WriterRef()
+         {
+            asyncLoads.fetch_add(1, boost::memory_order_seq_cst);
+            writer = asyncWriter.load(boost::memory_order_seq_cst);
+            if(writer)
+               writer->users.fetch_add(1, boost::memory_order_seq_cst);
+            asyncLoads.fetch_sub(1, boost::memory_order_seq_cst);
+         }
+
+         ~WriterRef()
+         {
+            Release();
+         }
+
+         void Release()
+         {
+            if(writer)
+               writer->users.fetch_sub(1, boost::memory_order_release);
+            writer = NULL;
+         }
+
+         AsyncWriter* operator->() const { return writer; }
+         operator bool() const { return writer!=NULL; }
+
+      private:
+         WriterRef(const WriterRef&);
+         WriterRef& operator =(const WriterRef&);
+
+         AsyncWriter* writer;
+      };
+
+      void StopAsync()
+      {
+         AsyncWriter* writer(asyncWriter.exchange(NULL, boost::memory_order_seq_cst));
+         if(!writer)
+            return;
+
+         // callers arriving from here on find no writer; the ones which found it are counted once
+         // the loads in flight are over, they give up waiting for room and leave shortly
+         writer->Stop();
+         while(asyncLoads.load(boost::memory_order_seq_cst))
+            boost::this_thread::yield();
+         while(writer->users.load(boost::memory_order_acquire))
+            boost::this_thread::yield();
+
+         writer->Close();
+         delete writer;
       }
 
-      std::string& StringInternalField(const System::String& string);
+      const size_t outputLevels = 4;
+      thread_local std::string outputBuffers[outputLevels];
+      thread_local size_t outputDepth = 0;
+
+      // Text is rendered into a thread-local buffer before taking the console lock, then written in
+      // one call. An argument's ToString() may write to the console in turn, every nesting level
+      // renders into a buffer of its own, the deepest ones into a local string.
+      class OutputBuffer
+      {
+      public:
+         OutputBuffer()
+            : level(outputDepth++)
+            , text(level<outputLevels ? outputBuffers[level] : local)
+         {
+            text.clear();
+         }
+
+         ~OutputBuffer()
+         {
+            outputDepth--;
+         }
+
+         std::string& Text() { return text; }
+
+      private:
+         OutputBuffer(const OutputBuffer&);
+         OutputBuffer& operator =(const OutputBuffer&);
+
+         const size_t level;
+         std::string local;
+         std::string& text;
+      };
+
+      void Output(std::string& text)
+      {
+         WriterRef writer;
+         const bool queued(writer && writer->Push(text));
+         writer.Release();
+         if(!queued)
+            WriteOut(text);
+
+         // one long line should not pin its capacity for the thread's lifetime
+         if(text.capacity()>(64<<10))
+            std::string().swap(text);
+      }
    }
 }
 
 using namespace System;
 using namespace System::Threading;
 
+void Console::EnableAsync(size_t capacity, OverflowPolicy policy)
+{
+   static const int registered(atexit(&Private::StopAsync));
+   (void)registered;
+
+   size_t slots(2);
+   while(slots<capacity)
+      slots *= 2;
+
+   Private::StopAsync();
+   Private::asyncWriter.store(new Private::AsyncWriter(slots, policy));
+}
+
+void Console::DisableAsync()
+{
+   Private::StopAsync();
+}
+
+bool Console::IsAsync()
+{
+   return Private::asyncWriter.load()!=NULL;
+}
+
+void Console::Flush()
+{
+   Private::WriterRef writer;
+   if(writer)
+      writer->Flush();
+   else
+   {
+      Locker lock(Private::SyncRoot());
+      std::cout.flush();
+   }
+}
+
+size_t Console::Dropped()
+{
+   Private::WriterRef writer;
+   return writer ? writer->Dropped() : 0;
+}
+
+void Console::Write(const String& string)
+{
+   Private::OutputBuffer buffer;
+   std::string& text(buffer.Text());
+   text += Private::StringInternalField(string);
+   Private::Output(text);
+}
+
+void Console::WriteLine(const String& string)
+{
+   Private::OutputBuffer buffer;
+   std::string& text(buffer.Text());
+   text += Private::StringInternalField(string);
+   text += '\n';
+   Private::Output(text);
+}
+
 void Console::Write(const String& format, const Collections::StringCollection& args)
 {
-   Locker lock(Private::SyncRoot());
-   std::cout << Private::StringInternalField(format);
-   // TODO: manage format string and args
-   for(size_t i=0; i<args.Count(); i++)
-      std::cout << Private::StringInternalField(args[i]);
+   Print(format, args, false);
 }
 
 void Console::WriteLine(const String& format, const Collections::StringCollection& args)
 {
-   Locker lock(Private::SyncRoot());
-   std::cout << Private::StringInternalField(format);
-   // TODO: manage format string and args
-   for(size_t i=0; i<args.Count(); i++)
-      std::cout << Private::StringInternalField(args[i]);
-   std::cout << std::endl;
+   Print(format, args, true);
+}
+
+void Console::Print(const String& format, const FormatArgument* const* args, size_t count, bool newLine)
+{
+   Private::OutputBuffer buffer;
+   std::string& text(buffer.Text());
+   Private::AppendFormat(text, format, args, count);
+   if(newLine)
+      text += '\n';
+   Private::Output(text);
+}
+
+void Console::Print(const String& format, const Collections::StringCollection& args, bool newLine)
+{
+   const std::vector<String> values(args.ToArray());
+   const std::vector<FormatArgument> arguments(values.begin(), values.end());
+   std::vector<const FormatArgument*> pointers;
+   for(size_t i=0; i<arguments.size(); i++)
+      pointers.push_back(&arguments[i]);
+
+   Print(format, pointers.empty() ? NULL : &pointers[0], pointers.size(), newLine);
 }
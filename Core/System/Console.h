@@ -27,67 +27,79 @@
 
 #include <System/SimpleObject.h>
 #include <System/String.h>
+#include <System/Format.h>
 #include <System/Collections/StringCollection.h>
 
 namespace System
 {
+   // Lines end with '\n' without flushing. Formats follow .NET composite formatting,
+   // "{index[,alignment][:formatString]}", see System/Format.h, and throw FormatException.
+   // Output is written by the calling thread under a console lock, or after EnableAsync() queued
+   // for a background writer that batches it into large writes.
    class Console : public SimpleObject
    {
    public:
-      static void Write(const std::string& string) { Console::Write(String(string)); }
-      static void WriteLine(const std::string& string) { Console::WriteLine(String(string)); }
+      // what a write does when the asynchronous queue is full: wait for room, discard the new
+      // text, or discard the oldest queued text
+      enum OverflowPolicy { Block, Drop, Overwrite };
 
-      static void Write(const String& string) { WriteLine(string, Collections::StringCollection()); }
-      static void WriteLine(const String& string) { WriteLine(string, Collections::StringCollection()); }
+      // capacity counts writes and is rounded up to a power of two. Switch modes while no other
+      // thread writes, typically at start-up and shutdown; exit() flushes an asynchronous console.
+      static void EnableAsync(size_t capacity = 4096, OverflowPolicy policy = Block);
+      static void DisableAsync();
+      static bool IsAsync();
+
+      // returns once everything written before the call is out
+      static void Flush();
+      // writes discarded by Drop and Overwrite since EnableAsync()
+      static size_t Dropped();
+
+      static void Write(const std::string& string) { Console::Write(String::Transient(string)); }
+      static void WriteLine(const std::string& string) { Console::WriteLine(String::Transient(string)); }
+
+      static void Write(const String& string);
+      static void WriteLine(const String& string);
 
       static void Write(const Object& object) { Console::Write(object.ToString()); }
       static void WriteLine(const Object& object) { Console::WriteLine(object.ToString()); }
 
-      static void Write(const Object& format, const Object& arg1)
+      static void Write(const String& format, const FormatArgument& arg1)
       {
-         Collections::StringCollection args;
-         args.Add(arg1.ToString());
-         Console::Write(String(format.ToString()), args);
+         const FormatArgument* args[] = { &arg1 };
+         Print(format, args, 1, false);
       }
-      static void Write(const Object& format, const Object& arg1, const Object& arg2)
+      static void Write(const String& format, const FormatArgument& arg1, const FormatArgument& arg2)
       {
-         Collections::StringCollection args;
-         args.Add(arg1.ToString());
-         args.Add(arg2.ToString());
-         Console::Write(String(format.ToString()), args);
+         const FormatArgument* args[] = { &arg1, &arg2 };
+         Print(format, args, 2, false);
       }
-      static void Write(const Object& format, const Object& arg1, const Object& arg2, const Object& arg3)
+      static void Write(const String& format, const FormatArgument& arg1, const FormatArgument& arg2, const FormatArgument& arg3)
       {
-         Collections::StringCollection args;
-         args.Add(arg1.ToString());
-         args.Add(arg2.ToString());
-         args.Add(arg3.ToString());
-         Console::Write(String(format.ToString()), args);
+         const FormatArgument* args[] = { &arg1, &arg2, &arg3 };
+         Print(format, args, 3, false);
       }
 
-      static void WriteLine(const Object& format, const Object& arg1)
+      static void WriteLine(const String& format, const FormatArgument& arg1)
       {
-         Collections::StringCollection args;
-         args.Add(arg1.ToString());
-         Console::WriteLine(String(format.ToString()), args);
+         const FormatArgument* args[] = { &arg1 };
+         Print(format, args, 1, true);
       }
-      static void WriteLine(const Object& format, const Object& arg1, const Object& arg2)
+      static void WriteLine(const String& format, const FormatArgument& arg1, const FormatArgument& arg2)
       {
-         Collections::StringCollection args;
-         args.Add(arg1.ToString());
-         args.Add(arg2.ToString());
-         Console::WriteLine(String(format.ToString()), args);
+         const FormatArgument* args[] = { &arg1, &arg2 };
+         Print(format, args, 2, true);
       }
-      static void WriteLine(const Object& format, const Object& arg1, const Object& arg2, const Object& arg3)
+      static void WriteLine(const String& format, const FormatArgument& arg1, const FormatArgument& arg2, const FormatArgument& arg3)
       {
-         Collections::StringCollection args;
-         args.Add(arg1.ToString());
-         args.Add(arg2.ToString());
-         args.Add(arg3.ToString());
-         Console::WriteLine(String(format.ToString()), args);
+         const FormatArgument* args[] = { &arg1, &arg2, &arg3 };
+         Print(format, args, 3, true);
       }
 
       static void Write(const String& format, const Collections::StringCollection& args);
       static void WriteLine(const String& format, const Collections::StringCollection& args);
+
+   private:
+      static void Print(const String& format, const FormatArgument* const* args, size_t count, bool newLine);
+      static void Print(const String& format, const Collections::StringCollection& args, bool newLine);
    };
 }
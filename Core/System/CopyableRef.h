@@ -34,7 +34,7 @@ namespace System
    class CopyableRef : public SimpleObject
    {
    public:
-      CopyableRef() : object(ObjectRef::Create<T>()) {}
+      CopyableRef() : object(ObjectRef::Make<T>()) {}
 
       operator T&() { return object.Get<T>(); }
       operator const T&() const { return object.Get<T>(); }
@@ -0,0 +1,169 @@
+/**
+ * Copyright (c) 2011 Michel Foucault
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <System/Diagnostics/Instrumentation.h>
+#include <System/Type.h>
+
+#include <chrono>
+#include <cstring>
+#include <map>
+
+#include <boost/thread/mutex.hpp>
+typedef boost::lock_guard<boost::mutex> lock_t;
+
+using namespace System;
+using namespace System::Diagnostics;
+
+boost::atomic<bool> Detail::enabled(false);
+
+namespace
+{
+   struct NameLess
+   {
+      bool operator()(const char* left, const char* right) const { return strcmp(left, right)<0; }
+   };
+
+   // leaked, counters are referenced from function statics and live pimpls
+   struct Registry
+   {
+      boost::mutex mutex;
+      std::map<const std::type_info*, Detail::TypeCounters*> types;
+      std::map<const char*, Detail::LockCounters*, NameLess> locks;
+   };
+
+   Registry& registry()
+   {
+      static Registry* registry(new Registry);
+      return *registry;
+   }
+}
+
+Detail::TypeCounters& Detail::Counters(const std::type_info& type)
+{
+   Registry& r(registry());
+   lock_t lock(r.mutex);
+
+   Detail::TypeCounters*& counters(r.types[&type]);
+   if(!counters)
+      counters = new Detail::TypeCounters;
+   return *counters;
+}
+
+Detail::LockCounters& Detail::Counters(const char* lockName)
+{
+   Registry& r(registry());
+   lock_t lock(r.mutex);
+
+   Detail::LockCounters*& counters(r.locks[lockName]);
+   if(!counters)
+      counters = new Detail::LockCounters;
+   return *counters;
+}
+
+Int64 Detail::Nanoseconds()
+{
+   typedef std::chrono::steady_clock clock;
+   return std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now().time_since_epoch()).count();
+}
+
+void Instrumentation::Enable(bool enable)
+{
+   Detail::enabled.store(enable, boost::memory_order_relaxed);
+}
+
+std::vector<TypeStatistics> Instrumentation::Types()
+{
+   std::vector<std::pair<const std::type_info*, Detail::TypeCounters*> > types;
+   {
+      Registry& r(registry());
+      lock_t lock(r.mutex);
+      types.assign(r.types.begin(), r.types.end());
+   }
+
+   // names are resolved outside the lock, Type interns a String which may be counted itself
+   std::map<std::string, TypeStatistics> merged;
+   for(size_t i=0; i<types.size(); i++)
+   {
+      const std::string name(Type::FromTypeInfo(*types[i].first).ToString());
+      const Detail::TypeCounters& counters(*types[i].second);
+
+      TypeStatistics& stats(merged[name]);
+      stats.Name = name;
+      stats.Live += counters.live.load(boost::memory_order_relaxed);
+      stats.Allocations += counters.allocations.load(boost::memory_order_relaxed);
+      stats.ReferenceOperations += counters.referenceOperations.load(boost::memory_order_relaxed);
+   }
+
+   std::vector<TypeStatistics> ret;
+   ret.reserve(merged.size());
+   for(std::map<std::string, TypeStatistics>::const_iterator it=merged.begin(); it!=merged.end(); ++it)
+      ret.push_back(it->second);
+   return ret;
+}
+
+std::vector<LockStatistics> Instrumentation::Locks()
+{
+   std::vector<LockStatistics> ret;
+
+   Registry& r(registry());
+   lock_t lock(r.mutex);
+   for(std::map<const char*, Detail::LockCounters*, NameLess>::const_iterator it=r.locks.begin(); it!=r.locks.end(); ++it)
+   {
+      const Detail::LockCounters& counters(*it->second);
+
+      LockStatistics stats;
+      stats.Name = it->first;
+      stats.Acquisitions = counters.acquisitions.load(boost::memory_order_relaxed);
+      stats.Contentions = counters.contentions.load(boost::memory_order_relaxed);
+      stats.WaitSeconds = counters.waitNanoseconds.load(boost::memory_order_relaxed)*1e-9;
+      ret.push_back(stats);
+   }
+
+   return ret;
+}
+
+Memory::PoolStatistics Instrumentation::Pool()
+{
+   return Memory::Pool::Statistics();
+}
+
+void Instrumentation::Reset()
+{
+   Registry& r(registry());
+   lock_t lock(r.mutex);
+
+   for(std::map<const std::type_info*, Detail::TypeCounters*>::iterator it=r.types.begin(); it!=r.types.end(); ++it)
+   {
+      it->second->allocations.store(0, boost::memory_order_relaxed);
+      it->second->referenceOperations.store(0, boost::memory_order_relaxed);
+   }
+
+   for(std::map<const char*, Detail::LockCounters*, NameLess>::iterator it=r.locks.begin(); it!=r.locks.end(); ++it)
+   {
+      it->second->acquisitions.store(0, boost::memory_order_relaxed);
+      it->second->contentions.store(0, boost::memory_order_relaxed);
+      it->second->waitNanoseconds.store(0, boost::memory_order_relaxed);
+   }
+}
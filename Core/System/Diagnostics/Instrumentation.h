@@ -0,0 +1,151 @@
+/**
+ * Copyright (c) 2011 Michel Foucault
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <Config.h>
+#include <System/Memory/Pool.h>
+
+#include <typeinfo>
+#include <vector>
+
+#include <boost/atomic.hpp>
+
+namespace System
+{
+   namespace Diagnostics
+   {
+      struct TypeStatistics
+      {
+         TypeStatistics()
+            : Live(0)
+            , Allocations(0)
+            , ReferenceOperations(0)
+         {}
+
+         std::string Name;
+         Int64 Live;                // pimpls or ObjectRef blocks created while enabled and not yet deleted
+         Int64 Allocations;         // created while enabled
+         Int64 ReferenceOperations; // reference count increments and decrements on those
+      };
+
+      struct LockStatistics
+      {
+         LockStatistics()
+            : Acquisitions(0)
+            , Contentions(0)
+            , WaitSeconds(0.0)
+         {}
+
+         std::string Name;
+         Int64 Acquisitions;
+         Int64 Contentions; // acquisitions that had to block
+         double WaitSeconds; // total time spent blocked
+      };
+
+      namespace Detail
+      {
+         typedef boost::atomic<Int64> Counter;
+
+         inline void Bump(Counter& counter, Int64 delta = 1)
+         {
+            counter.fetch_add(delta, boost::memory_order_relaxed);
+         }
+
+         struct TypeCounters
+         {
+            TypeCounters() : live(0), allocations(0), referenceOperations(0) {}
+
+            Counter live;
+            Counter allocations;
+            Counter referenceOperations;
+         };
+
+         struct LockCounters
+         {
+            LockCounters() : acquisitions(0), contentions(0), waitNanoseconds(0) {}
+
+            Counter acquisitions;
+            Counter contentions;
+            Counter waitNanoseconds;
+         };
+
+         extern boost::atomic<bool> enabled;
+
+         inline bool IsEnabled() { return enabled.load(boost::memory_order_relaxed); }
+
+         // registered on first use and never freed
+         TypeCounters& Counters(const std::type_info& type);
+         LockCounters& Counters(const char* lockName);
+
+         template<class T>
+         TypeCounters& CountersOf()
+         {
+            static TypeCounters& counters(Counters(typeid(T)));
+            return counters;
+         }
+
+         Int64 Nanoseconds();
+
+         // lock a boost Lockable, uncontended acquisitions are not timed
+         template<class L>
+         void Lock(L& lockable, LockCounters& counters)
+         {
+            if(!IsEnabled())
+            {
+               lockable.lock();
+               return;
+            }
+
+            Bump(counters.acquisitions);
+            if(lockable.try_lock())
+               return;
+
+            const Int64 start(Nanoseconds());
+            lockable.lock();
+            Bump(counters.contentions);
+            Bump(counters.waitNanoseconds, Nanoseconds()-start);
+         }
+      }
+
+      // Opt-in runtime counters for handle types and framework locks. Disabled by default,
+      // a disabled build only pays a flag test on handle creation and lock acquisition.
+      class Instrumentation
+      {
+      public:
+         static void Enable(bool enable = true);
+         static bool IsEnabled() { return Detail::IsEnabled(); }
+
+         // sorted by name, types and locks never seen while enabled are not listed
+         static std::vector<TypeStatistics> Types();
+         static std::vector<LockStatistics> Locks();
+         // Memory::Pool keeps its counters whether enabled or not, Reset() leaves them
+         static Memory::PoolStatistics Pool();
+
+         // zero every counter but the live counts
+         static void Reset();
+      };
+   }
+}
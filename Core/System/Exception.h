@@ -49,4 +49,5 @@ namespace System
    class OutOfBoundException : public Exception {};
    class NotImplementedException : public Exception {};
    class InvalidArgumentException : public Exception {};
+   class FormatException : public Exception {};
 }
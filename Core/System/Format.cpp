@@ -0,0 +1,391 @@
+/**
+ * Copyright (c) 2011 Michel Foucault
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+// Composite formats are parsed once into literal runs and placeholders. Parsed formats stay in a
+// small per-thread cache indexed by the format's content hash, so a format used in a loop is
+// parsed on its first call only. Arguments render straight into the caller's buffer.
+
+#include <System/Format.h>
+#include <System/Exception.h>
+
+#include <cstdarg>
+#include <cstdio>
+#include <vector>
+
+namespace System
+{
+   namespace Private
+   {
+      struct FormatItem
+      {
+         FormatItem(size_t literalEnd)
+            : literalEnd(literalEnd)
+            , index(-1)
+            , alignment(0)
+            , specifier(0)
+            , precision(-1)
+            , custom(false)
+         {}
+
+         size_t literalEnd;   // end of the literal before the placeholder in ParsedFormat::text
+         int index;           // -1 on the item closing the last literal
+         int alignment;
+         char specifier;      // 0 when absent
+         int precision;       // -1 when absent
+         bool custom;         // the format string is not a standard one, numbers reject it
+      };
+
+      struct ParsedFormat
+      {
+         std::string text;    // all literals, escapes resolved
+         std::vector<FormatItem> items;
+      };
+
+      // the .NET limit on index and alignment
+      const int formatLimit = 1000000;
+
+      int ParseNumber(const char*& p, const char* end)
+      {
+         if(p==end || *p<'0' || *p>'9')
+            throw FormatException();
+
+         int value(0);
+         for(; p<end && *p>='0' && *p<='9'; p++)
+         {
+            value = value*10 + (*p-'0');
+            if(value>=formatLimit)
+               throw FormatException();
+         }
+         return value;
+      }
+
+      void SkipSpaces(const char*& p, const char* end)
+      {
+         while(p<end && *p==' ')
+            p++;
+      }
+
+      // a standard format is one letter and a precision of up to two digits
+      void ParseStandardFormat(const char* p, const char* end, FormatItem& item)
+      {
+         const char* letter(p);
+         if(p<end && ((*p>='A' && *p<='Z') || (*p>='a' && *p<='z')))
+            p++;
+         const char* digits(p);
+         while(p<end && *p>='0' && *p<='9')
+            p++;
+
+         if(p!=end || (digits==letter && p!=letter) || p-digits>2)
+         {
+            item.custom = true;
+            return;
+         }
+
+         if(digits!=letter)
+            item.specifier = *letter;
+         if(p!=digits)
+            item.precision = ParseNumber(digits, end);
+      }
+
+      // p follows the opening brace
+      FormatItem ParsePlaceholder(const char*& p, const char* end, size_t literalEnd)
+      {
+         FormatItem item(literalEnd);
+         item.index = ParseNumber(p, end);
+         SkipSpaces(p, end);
+
+         if(p<end && *p==',')
+         {
+            SkipSpaces(++p, end);
+            const bool left(p<end && *p=='-');
+            if(left)
+               p++;
+            item.alignment = left ? -ParseNumber(p, end) : ParseNumber(p, end);
+            SkipSpaces(p, end);
+         }
+
+         // the format string runs to the closing brace, it is only interpreted for numbers
+         if(p<end && *p==':')
+         {
+            const char* format(++p);
+            while(p<end && *p!='}' && *p!='{')
+               p++;
+            ParseStandardFormat(format, p, item);
+         }
+
+         if(p==end || *p++!='}')
+            throw FormatException();
+         return item;
+      }
+
+      ParsedFormat Parse(const std::string& format)
+      {
+         ParsedFormat parsed;
+         const char* p(format.data());
+         const char* end(p+format.size());
+         while(p<end)
+         {
+            const char c(*p++);
+            if((c=='{' || c=='}') && p<end && *p==c)
+               parsed.text += *p++;
+            else if(c=='{')
+               parsed.items.push_back(ParsePlaceholder(p, end, parsed.text.size()));
+            else if(c=='}')
+               throw FormatException();
+            else
+               parsed.text += c;
+         }
+         parsed.items.push_back(FormatItem(parsed.text.size()));
+         return parsed;
+      }
+
+      // Direct mapped, a format evicts the one sharing its slot. Formatting may nest on a thread, an
+      // argument's ToString() formatting in turn: while a cached format is in use, a miss is parsed
+      // into the caller's scratch instead, so no slot is replaced under an outer call.
+      class FormatCache
+      {
+      public:
+         FormatCache() : users(0) {}
+
+         class Use
+         {
+         public:
+            Use(FormatCache& cache) : cache(cache) { cache.users++; }
+            ~Use() { cache.users--; }
+
+         private:
+            FormatCache& cache;
+         };
+
+         const ParsedFormat& Get(const String& format, ParsedFormat& scratch)
+         {
+            const std::string& text(StringInternalField(format));
+            const size_t hash(format.HashCode());
+
+            Slot& slot(slots[hash%slotCount]);
+            if(!slot.used || slot.hash!=hash || slot.format!=text)
+            {
+               if(users>1)
+               {
+                  scratch = Parse(text);
+                  return scratch;
+               }
+
+               ParsedFormat parsed(Parse(text));
+               std::swap(slot.parsed, parsed);
+               slot.format = text;
+               slot.hash = hash;
+               slot.used = true;
+            }
+            return slot.parsed;
+         }
+
+      private:
+         static const size_t slotCount = 64;
+
+         struct Slot
+         {
+            Slot() : used(false), hash(0) {}
+
+            bool used;
+            size_t hash;
+            std::string format;
+            ParsedFormat parsed;
+         };
+
+         Slot slots[slotCount];
+         int users;
+      };
+
+      thread_local FormatCache formatCache;
+
+      void AppendPrintf(std::string& out, const char* format, ...)
+      {
+         // room for any double in fixed notation under the two digit precision limit
+         char buffer[512];
+         va_list args;
+         va_start(args, format);
+         const int size(vsnprintf(buffer, sizeof(buffer), format, args));
+         va_end(args);
+         out.append(buffer, size);
+      }
+
+      // decimal digits without printf, the common case of a plain {0}
+      void AppendDecimal(std::string& out, unsigned long long magnitude, bool negative, int minimumDigits)
+      {
+         char digits[20];
+         char* first(digits+sizeof(digits));
+         do
+         {
+            *--first = static_cast<char>('0'+magnitude%10);
+            magnitude /= 10;
+         }
+         while(magnitude);
+
+         if(negative)
+            out += '-';
+         const int count(static_cast<int>(digits+sizeof(digits)-first));
+         if(count<minimumDigits)
+            out.append(minimumDigits-count, '0');
+         out.append(first, count);
+      }
+
+      // a ',' between each group of three integer digits appended after start
+      void GroupThousands(std::string& out, size_t start)
+      {
+         if(out[start]=='-')
+            start++;
+         size_t integerEnd(out.find('.', start));
+         if(integerEnd==std::string::npos)
+            integerEnd = out.size();
+         for(size_t group=integerEnd; group>start+3; group-=3)
+            out.insert(group-3, 1, ',');
+      }
+
+      class Formatter
+      {
+      public:
+         static void Append(std::string& out, const String& format, const FormatArgument* const* args, size_t count)
+         {
+            FormatCache::Use use(formatCache);
+            ParsedFormat scratch;
+            const ParsedFormat& parsed(formatCache.Get(format, scratch));
+
+            size_t literalBegin(0);
+            for(std::vector<FormatItem>::const_iterator item=parsed.items.begin(); item!=parsed.items.end(); ++item)
+            {
+               out.append(parsed.text, literalBegin, item->literalEnd-literalBegin);
+               literalBegin = item->literalEnd;
+               if(item->index<0)
+                  break;
+               if(static_cast<size_t>(item->index)>=count)
+                  throw FormatException();
+
+               const size_t start(out.size());
+               AppendArgument(out, *args[item->index], *item);
+
+               const size_t width(item->alignment<0 ? -item->alignment : item->alignment);
+               if(out.size()-start<width)
+               {
+                  if(item->alignment>0)
+                     out.insert(start, width-(out.size()-start), ' ');
+                  else
+                     out.append(width-(out.size()-start), ' ');
+               }
+            }
+         }
+
+      private:
+         static void AppendArgument(std::string& out, const FormatArgument& arg, const FormatItem& item)
+         {
+            switch(arg.kind)
+            {
+            case FormatArgument::Boolean:
+               out += arg.signedValue ? "True" : "False";
+               break;
+            case FormatArgument::Character:
+               out += static_cast<char>(arg.signedValue);
+               break;
+            case FormatArgument::Characters:
+               if(arg.characters)
+                  out += arg.characters;
+               break;
+            case FormatArgument::StdString:
+               out += *arg.stdString;
+               break;
+            case FormatArgument::StringObject:
+               out += StringInternalField(*arg.string);
+               break;
+            case FormatArgument::GenericObject:
+               out += arg.object->ToString();
+               break;
+            default:
+               if(item.custom)
+                  throw FormatException();
+               AppendNumber(out, arg, item.specifier, item.precision);
+               break;
+            }
+         }
+
+         static void AppendNumber(std::string& out, const FormatArgument& arg, char specifier, int precision)
+         {
+            const bool integer(arg.kind!=FormatArgument::Floating);
+            const bool negative(arg.kind==FormatArgument::Signed && arg.signedValue<0);
+            const unsigned long long bits(arg.kind==FormatArgument::Signed ? static_cast<unsigned long long>(arg.signedValue) : arg.unsignedValue);
+            const double value(arg.kind==FormatArgument::Floating ? arg.floatingValue
+                               : arg.kind==FormatArgument::Signed ? static_cast<double>(arg.signedValue)
+                               : static_cast<double>(arg.unsignedValue));
+
+            const bool lower(specifier>='a' && specifier<='z');
+            switch(lower ? specifier-'a'+'A' : specifier)
+            {
+            case 0:
+            case 'G':
+               if(integer)
+                  AppendDecimal(out, negative ? 0-bits : bits, negative, 1);
+               else if(precision<0)
+                  AppendPrintf(out, lower ? "%g" : "%G", value);
+               else
+                  AppendPrintf(out, lower ? "%.*g" : "%.*G", precision, value);
+               break;
+            case 'D':
+               if(!integer)
+                  throw FormatException();
+               AppendDecimal(out, negative ? 0-bits : bits, negative, precision);
+               break;
+            case 'X':
+               if(!integer)
+                  throw FormatException();
+               AppendPrintf(out, lower ? "%0*llx" : "%0*llX", precision<0 ? 1 : precision,
+                            arg.width<sizeof(bits) ? bits & ((1ULL<<8*arg.width)-1) : bits);
+               break;
+            case 'F':
+               AppendPrintf(out, "%.*f", precision<0 ? 2 : precision, value);
+               break;
+            case 'N':
+            {
+               const size_t start(out.size());
+               AppendPrintf(out, "%.*f", precision<0 ? 2 : precision, value);
+               GroupThousands(out, start);
+               break;
+            }
+            case 'E':
+               AppendPrintf(out, lower ? "%.*e" : "%.*E", precision<0 ? 6 : precision, value);
+               break;
+            case 'P':
+               AppendPrintf(out, "%.*f %%", precision<0 ? 2 : precision, value*100);
+               break;
+            default:
+               throw FormatException();
+            }
+         }
+      };
+
+      void AppendFormat(std::string& out, const String& format, const FormatArgument* const* args, size_t count)
+      {
+         Formatter::Append(out, format, args, count);
+      }
+   }
+}
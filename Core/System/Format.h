@@ -0,0 +1,82 @@
+/**
+ * Copyright (c) 2011 Michel Foucault
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <string>
+#include <System/Object.h>
+#include <System/String.h>
+
+namespace System
+{
+   class FormatArgument;
+
+   namespace Private
+   {
+      class Formatter;
+      void AppendFormat(std::string& out, const String& format, const FormatArgument* const* args, size_t count);
+   }
+
+   // One argument of a composite format "{index[,alignment][:formatString]}". It refers to the
+   // value without copying or converting it, so it only lives as long as the call it is passed to.
+   // Numbers take the standard formats D, X, N, F, E, G and P with an optional precision and throw
+   // FormatException on any other format string. Strings and objects ignore the format string.
+   class FormatArgument
+   {
+   public:
+      FormatArgument(bool value) : kind(Boolean), width(sizeof(value)), signedValue(value) {}
+      FormatArgument(char value) : kind(Character), width(sizeof(value)), signedValue(value) {}
+      FormatArgument(int value) : kind(Signed), width(sizeof(value)), signedValue(value) {}
+      FormatArgument(unsigned int value) : kind(Unsigned), width(sizeof(value)), unsignedValue(value) {}
+      FormatArgument(long value) : kind(Signed), width(sizeof(value)), signedValue(value) {}
+      FormatArgument(unsigned long value) : kind(Unsigned), width(sizeof(value)), unsignedValue(value) {}
+      FormatArgument(long long value) : kind(Signed), width(sizeof(value)), signedValue(value) {}
+      FormatArgument(unsigned long long value) : kind(Unsigned), width(sizeof(value)), unsignedValue(value) {}
+      FormatArgument(double value) : kind(Floating), width(sizeof(value)), floatingValue(value) {}
+      FormatArgument(const char* value) : kind(Characters), width(0), characters(value) {}
+      FormatArgument(const std::string& value) : kind(StdString), width(0), stdString(&value) {}
+      FormatArgument(const String& value) : kind(StringObject), width(0), string(&value) {}
+      FormatArgument(const Object& value) : kind(GenericObject), width(0), object(&value) {}
+
+   private:
+      friend class Private::Formatter;
+
+      enum Kind { Boolean, Character, Signed, Unsigned, Floating, Characters, StdString, StringObject, GenericObject };
+
+      Kind kind;
+      // size of the integer type, X formats negative values in its two's complement
+      unsigned char width;
+      union
+      {
+         long long signedValue;
+         unsigned long long unsignedValue;
+         double floatingValue;
+         const char* characters;
+         const std::string* stdString;
+         const String* string;
+         const Object* object;
+      };
+   };
+}
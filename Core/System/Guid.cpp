@@ -34,28 +34,21 @@
 #include <sstream>
 
 
-#include <boost/thread/mutex.hpp>
-typedef boost::lock_guard<boost::mutex> lock_t;
-
 namespace System
 {
    namespace Private
    {
-      class Guid : public System::Pimpl
+      class Guid : public System::SharedPimpl
       {
       public:
          Guid()
-            : referenceCount(0)
-            , guid(boost::uuids::nil_generator()())
+            : guid(boost::uuids::nil_generator()())
          {}
 
          Guid(const std::string& string)
-            : referenceCount(0)
-            , guid(boost::uuids::string_generator()(string))
+            : guid(boost::uuids::string_generator()(string))
          {}
 
-         size_t ReferenceCount() const;
-
          void Random()
          {
             guid = boost::uuids::random_generator()();
@@ -74,7 +67,6 @@ namespace System
             std::copy(guid.begin(), guid.end(), bytes.begin());
          }
 
-         int referenceCount;
          boost::uuids::uuid guid;
       };
    }
@@ -82,77 +74,27 @@ namespace System
 
 using namespace System;
 
-static boost::mutex& m(){
-   static boost::mutex mtx;
-   return mtx;
-}
-#define LOCK lock_t l(m());
-#define PIMPL_REF(r) static_cast<Private::Guid*>((r).p)
+#define PIMPL_REF(r) (r).p.Get()
 #define PIMPL Private::Guid* p(PIMPL_REF(*this));
 
-size_t Private::Guid::ReferenceCount() const
-{
-   LOCK
-   return referenceCount;
-}
-
 Guid::Guid()
   : p(new Private::Guid)
-{
-   LOCK
-   PIMPL
-   p->referenceCount++;
-}
+{}
 
 Guid::Guid(String string)
   : p(new Private::Guid(string))
-{
-   LOCK
-   PIMPL
-   p->referenceCount++;
-}
-
-Guid::~Guid()
-{
-   LOCK
-   PIMPL
-   p->referenceCount--;
-   if(!p->referenceCount)
-      delete p;
-}
+{}
 
-Guid::Guid(const Guid& src)
-  : p(src.p)
-{
-   LOCK
-   PIMPL
-   p->referenceCount++;
-}
-
-Guid& Guid::operator =(const Guid& src)
+size_t Guid::HashCode() const
 {
-   if(this==&src)
-      return *this;
-
-   LOCK
-   {
-      PIMPL
-      p->referenceCount--;
-      if(!p->referenceCount)
-         delete p;
-   }
-
-   this->p = src.p;
    PIMPL
-   p->referenceCount++;
-
-   return *this;
+   return boost::uuids::hash_value(p->guid);
 }
 
-size_t Guid::HashCode() const
+bool Guid::Equals(const Object& other) const
 {
-   PIMPL
-   return (size_t)p;
+   const Guid* guid = dynamic_cast<const Guid*>(&other);
+   return guid && *this==*guid;
 }
 
 std::string Guid::ToString() const
@@ -26,10 +26,13 @@
 #pragma once
 
 #include <System/Object.h>
+#include <System/SharedPimpl.h>
 #include <System/String.h>
 
 namespace System
 {
+   namespace Private { class Guid; }
+
    class Guid : public Object
    {
    public:
@@ -39,16 +42,14 @@ namespace System
 
       Guid();
       Guid(String string);
-      virtual ~Guid();
-      Guid(const Guid& src);
-      Guid& operator =(const Guid& src);
 
       size_t HashCode() const;
+      bool Equals(const Object& other) const;
       std::string ToString() const;
 
       bool operator ==(const Guid comp) const;
 
    private:
-      Pimpl* p;
+      SharedHandle<Private::Guid> p;
    };
 }
@@ -25,91 +25,31 @@
 
 #include <System/HashCodeHandler.h>
 
-#include <boost/thread/mutex.hpp>
-typedef boost::lock_guard<boost::mutex> lock_t;
-
 namespace System
 {
    namespace Private
    {
-      class HashCodeHandler : public System::Pimpl
+      class HashCodeHandler : public System::SharedPimpl
       {
       public:
          HashCodeHandler()
-            : referenceCount(0)
          {}
 
-         size_t ReferenceCount() const;
-
-         int referenceCount;
       };
    }
 }
 
 using namespace System;
 
-static boost::mutex& m(){
-   static boost::mutex mtx;
-   return mtx;
-}
-#define LOCK lock_t l(m());
-#define PIMPL Private::HashCodeHandler* p(static_cast<Private::HashCodeHandler*>(this->p));
-
-size_t Private::HashCodeHandler::ReferenceCount() const
-{
-   LOCK
-   return referenceCount;
-}
+#define PIMPL Private::HashCodeHandler* p(this->p.Get());
 
 HashCodeHandler::HashCodeHandler()
   : p(new Private::HashCodeHandler)
-{
-   LOCK
-   PIMPL
-   p->referenceCount++;
-}
-
-HashCodeHandler::~HashCodeHandler()
-{
-   LOCK
-   PIMPL
-   p->referenceCount--;
-   if(!p->referenceCount)
-      delete p;
-}
-
-HashCodeHandler::HashCodeHandler(const HashCodeHandler& src)
-  : p(src.p)
-{
-   LOCK
-   PIMPL
-   p->referenceCount++;
-}
-
-HashCodeHandler& HashCodeHandler::operator =(const HashCodeHandler& src)
-{
-   if(this==&src)
-      return *this;
-
-   LOCK
-   {
-      PIMPL
-      p->referenceCount--;
-      if(!p->referenceCount)
-         delete p;
-   }
-
-   this->p = src.p;
-   PIMPL
-   p->referenceCount++;
-
-   return *this;
-}
+{}
 
 size_t HashCodeHandler::HashCode() const
 {
-   PIMPL
-   return (size_t)p;
+   return p.HashCode();
 }
 
 HashCodeHandler::operator size_t() const
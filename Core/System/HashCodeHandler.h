@@ -26,21 +26,21 @@
 #pragma once
 
 #include <System/Object.h>
+#include <System/SharedPimpl.h>
 
 namespace System
 {
+   namespace Private { class HashCodeHandler; }
+
    class HashCodeHandler : public Object
    {
    public:
       HashCodeHandler();
-      virtual ~HashCodeHandler();
-      HashCodeHandler(const HashCodeHandler& src);
-      HashCodeHandler& operator =(const HashCodeHandler& src);
 
       size_t HashCode() const;
       operator size_t() const;
 
    private:
-      Pimpl* p;
+      SharedHandle<Private::HashCodeHandler> p;
    };
 }
@@ -25,25 +25,18 @@
 
 #include <System/IO/Directory.h>
 
-#include <boost/thread/mutex.hpp>
-typedef boost::lock_guard<boost::mutex> lock_t;
-
 namespace System
 {
    namespace IO
    {
       namespace Private
       {
-         class Directory : public System::Pimpl
+         class Directory : public System::SharedPimpl
          {
          public:
             Directory()
-               : referenceCount(0)
             {}
 
-            size_t ReferenceCount() const;
-
-            int referenceCount;
          };
       }
    }
@@ -51,66 +44,13 @@ namespace System
 
 using namespace System::IO;
 
-static boost::mutex& m(){
-   static boost::mutex mtx;
-   return mtx;
-}
-#define LOCK lock_t l(m());
-#define PIMPL Private::Directory* p(static_cast<Private::Directory*>(this->p));
-
-size_t Private::Directory::ReferenceCount() const
-{
-   LOCK
-   return referenceCount;
-}
+#define PIMPL Private::Directory* p(this->p.Get());
 
 Directory::Directory()
   : p(new Private::Directory)
-{
-   LOCK
-   PIMPL
-   p->referenceCount++;
-}
-
-Directory::~Directory()
-{
-   LOCK
-   PIMPL
-   p->referenceCount--;
-   if(!p->referenceCount)
-      delete p;
-}
-
-Directory::Directory(const Directory& src)
-  : p(src.p)
-{
-   LOCK
-   PIMPL
-   p->referenceCount++;
-}
-
-Directory& Directory::operator =(const Directory& src)
-{
-   if(this==&src)
-      return *this;
-
-   LOCK
-   {
-      PIMPL
-      p->referenceCount--;
-      if(!p->referenceCount)
-         delete p;
-   }
-
-   this->p = src.p;
-   PIMPL
-   p->referenceCount++;
-
-   return *this;
-}
+{}
 
 size_t Directory::HashCode() const
 {
-   PIMPL
-   return (size_t)p;
+   return p.HashCode();
 }
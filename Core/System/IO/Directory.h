@@ -26,23 +26,23 @@
 #pragma once
 
 #include <System/Object.h>
+#include <System/SharedPimpl.h>
 
 namespace System
 {
    namespace IO
    {
+      namespace Private { class Directory; }
+
       class Directory : public Object
       {
       public:
          Directory();
-         virtual ~Directory();
-         Directory(const Directory& src);
-         Directory& operator =(const Directory& src);
 
          size_t HashCode() const;
 
       private:
-         Pimpl* p;
+         SharedHandle<Private::Directory> p;
       };
    }
 }
@@ -25,25 +25,18 @@
 
 #include <System/IO/DirectoryInfo.h>
 
-#include <boost/thread/mutex.hpp>
-typedef boost::lock_guard<boost::mutex> lock_t;
-
 namespace System
 {
    namespace IO
    {
       namespace Private
       {
-         class DirectoryInfo : public System::Pimpl
+         class DirectoryInfo : public System::SharedPimpl
          {
          public:
             DirectoryInfo()
-               : referenceCount(0)
             {}
 
-            size_t ReferenceCount() const;
-
-            int referenceCount;
          };
       }
    }
@@ -51,66 +44,13 @@ namespace System
 
 using namespace System::IO;
 
-static boost::mutex& m(){
-   static boost::mutex mtx;
-   return mtx;
-}
-#define LOCK lock_t l(m());
-#define PIMPL Private::DirectoryInfo* p(static_cast<Private::DirectoryInfo*>(this->p));
-
-size_t Private::DirectoryInfo::ReferenceCount() const
-{
-   LOCK
-   return referenceCount;
-}
+#define PIMPL Private::DirectoryInfo* p(this->p.Get());
 
 DirectoryInfo::DirectoryInfo()
   : p(new Private::DirectoryInfo)
-{
-   LOCK
-   PIMPL
-   p->referenceCount++;
-}
-
-DirectoryInfo::~DirectoryInfo()
-{
-   LOCK
-   PIMPL
-   p->referenceCount--;
-   if(!p->referenceCount)
-      delete p;
-}
-
-DirectoryInfo::DirectoryInfo(const DirectoryInfo& src)
-  : p(src.p)
-{
-   LOCK
-   PIMPL
-   p->referenceCount++;
-}
-
-DirectoryInfo& DirectoryInfo::operator =(const DirectoryInfo& src)
-{
-   if(this==&src)
-      return *this;
-
-   LOCK
-   {
-      PIMPL
-      p->referenceCount--;
-      if(!p->referenceCount)
-         delete p;
-   }
-
-   this->p = src.p;
-   PIMPL
-   p->referenceCount++;
-
-   return *this;
-}
+{}
 
 size_t DirectoryInfo::HashCode() const
 {
-   PIMPL
-   return (size_t)p;
+   return p.HashCode();
 }
@@ -26,23 +26,23 @@
 #pragma once
 
 #include <System/Object.h>
+#include <System/SharedPimpl.h>
 
 namespace System
 {
    namespace IO
    {
+      namespace Private { class DirectoryInfo; }
+
       class DirectoryInfo : public Object
       {
       public:
          DirectoryInfo();
-         virtual ~DirectoryInfo();
-         DirectoryInfo(const DirectoryInfo& src);
-         DirectoryInfo& operator =(const DirectoryInfo& src);
 
          size_t HashCode() const;
 
       private:
-         Pimpl* p;
+         SharedHandle<Private::DirectoryInfo> p;
       };
    }
 }
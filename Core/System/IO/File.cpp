@@ -27,25 +27,18 @@
 #include <System/IO/Exception.h>
 #include <boost/filesystem.hpp>
 
-#include <boost/thread/mutex.hpp>
-typedef boost::lock_guard<boost::mutex> lock_t;
-
 namespace System
 {
    namespace IO
    {
       namespace Private
       {
-         class File : public System::Pimpl
+         class File : public System::SharedPimpl
          {
          public:
             File()
-               : referenceCount(0)
             {}
 
-            size_t ReferenceCount() const;
-
-            int referenceCount;
          };
       }
    }
@@ -54,68 +47,15 @@ namespace System
 using namespace System;
 using namespace System::IO;
 
-static boost::mutex& m(){
-   static boost::mutex mtx;
-   return mtx;
-}
-#define LOCK lock_t l(m());
-#define PIMPL Private::File* p(static_cast<Private::File*>(this->p));
-
-size_t Private::File::ReferenceCount() const
-{
-   LOCK
-   return referenceCount;
-}
+#define PIMPL Private::File* p(this->p.Get());
 
 File::File()
   : p(new Private::File)
-{
-   LOCK
-   PIMPL
-   p->referenceCount++;
-}
-
-File::~File()
-{
-   LOCK
-   PIMPL
-   p->referenceCount--;
-   if(!p->referenceCount)
-      delete p;
-}
-
-File::File(const File& src)
-  : p(src.p)
-{
-   LOCK
-   PIMPL
-   p->referenceCount++;
-}
-
-File& File::operator =(const File& src)
-{
-   if(this==&src)
-      return *this;
-
-   LOCK
-   {
-      PIMPL
-      p->referenceCount--;
-      if(!p->referenceCount)
-         delete p;
-   }
-
-   this->p = src.p;
-   PIMPL
-   p->referenceCount++;
-
-   return *this;
-}
+{}
 
 size_t File::HashCode() const
 {
-   PIMPL
-   return (size_t)p;
+   return p.HashCode();
 }
 
 bool File::Exists(String fileName)
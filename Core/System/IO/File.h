@@ -26,19 +26,19 @@
 #pragma once
 
 #include <System/Object.h>
+#include <System/SharedPimpl.h>
 #include <System/String.h>
 
 namespace System
 {
    namespace IO
    {
+      namespace Private { class File; }
+
       class File : public Object
       {
       public:
          File();
-         virtual ~File();
-         File(const File& src);
-         File& operator =(const File& src);
 
          size_t HashCode() const;
 
@@ -46,7 +46,7 @@ namespace System
          static System::Int64 Length(System::String fileName);
 
       private:
-         Pimpl* p;
+         SharedHandle<Private::File> p;
       };
    }
 }
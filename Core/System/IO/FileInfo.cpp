@@ -25,25 +25,18 @@
 
 #include <System/IO/FileInfo.h>
 
-#include <boost/thread/mutex.hpp>
-typedef boost::lock_guard<boost::mutex> lock_t;
-
 namespace System
 {
    namespace IO
    {
       namespace Private
       {
-         class FileInfo : public System::Pimpl
+         class FileInfo : public System::SharedPimpl
          {
          public:
             FileInfo()
-               : referenceCount(0)
             {}
 
-            size_t ReferenceCount() const;
-
-            int referenceCount;
          };
       }
    }
@@ -51,66 +44,13 @@ namespace System
 
 using namespace System::IO;
 
-static boost::mutex& m(){
-   static boost::mutex mtx;
-   return mtx;
-}
-#define LOCK lock_t l(m());
-#define PIMPL Private::FileInfo* p(static_cast<Private::FileInfo*>(this->p));
-
-size_t Private::FileInfo::ReferenceCount() const
-{
-   LOCK
-   return referenceCount;
-}
+#define PIMPL Private::FileInfo* p(this->p.Get());
 
 FileInfo::FileInfo()
   : p(new Private::FileInfo)
-{
-   LOCK
-   PIMPL
-   p->referenceCount++;
-}
-
-FileInfo::~FileInfo()
-{
-   LOCK
-   PIMPL
-   p->referenceCount--;
-   if(!p->referenceCount)
-      delete p;
-}
-
-FileInfo::FileInfo(const FileInfo& src)
-  : p(src.p)
-{
-   LOCK
-   PIMPL
-   p->referenceCount++;
-}
-
-FileInfo& FileInfo::operator =(const FileInfo& src)
-{
-   if(this==&src)
-      return *this;
-
-   LOCK
-   {
-      PIMPL
-      p->referenceCount--;
-      if(!p->referenceCount)
-         delete p;
-   }
-
-   this->p = src.p;
-   PIMPL
-   p->referenceCount++;
-
-   return *this;
-}
+{}
 
 size_t FileInfo::HashCode() const
 {
-   PIMPL
-   return (size_t)p;
+   return p.HashCode();
 }
@@ -26,23 +26,23 @@
 #pragma once
 
 #include <System/Object.h>
+#include <System/SharedPimpl.h>
 
 namespace System
 {
    namespace IO
    {
+      namespace Private { class FileInfo; }
+
       class FileInfo : public Object
       {
       public:
          FileInfo();
-         virtual ~FileInfo();
-         FileInfo(const FileInfo& src);
-         FileInfo& operator =(const FileInfo& src);
 
          size_t HashCode() const;
 
       private:
-         Pimpl* p;
+         SharedHandle<Private::FileInfo> p;
       };
    }
 }
@@ -30,9 +30,6 @@
 
 #include <fstream>
 
-#include <boost/thread/mutex.hpp>
-typedef boost::lock_guard<boost::mutex> lock_t;
-
 namespace System
 {
    namespace Private
@@ -45,29 +42,26 @@ namespace System
    {
       namespace Private
       {
-         class FileStream : public System::Pimpl
+         class FileStream : public System::SharedPimpl
          {
          public:
             FileStream()
-               : referenceCount(0)
-               , length(0)
+               : length(0)
             {}
 
-            size_t ReferenceCount() const;
-
             void Open(const std::string& fileName, const OpenMode& openMode)
             {
                if(IsOpen())
                   throw FileOpenException();
 
-               if(!File::Exists(String(fileName)) && (openMode==OpenMode::Read))
+               if(!IO::File::Exists(String::Transient(fileName)) && (openMode==OpenMode::Read))
                   throw FileOpenException();
-               if(File::Exists(String(fileName)) && (openMode==OpenMode::Write))
+               if(IO::File::Exists(String::Transient(fileName)) && (openMode==OpenMode::Write))
                   throw FileOpenException();
 
                Threading::Locker lock(syncRoot);
 
-               length = File::Length(String(fileName));
+               length = IO::File::Length(String::Transient(fileName));
 
                this->openMode = openMode;
                std::ios_base::openmode mode(std::ios_base::binary);
@@ -160,7 +154,6 @@ namespace System
                   throw FileWriteException();
             }
 
-            int referenceCount;
             Threading::Synchro syncRoot;
             OpenMode openMode;
             std::fstream fileStream;
@@ -173,68 +166,15 @@ namespace System
 using namespace System;
 using namespace System::IO;
 
-static boost::mutex& m(){
-   static boost::mutex mtx;
-   return mtx;
-}
-#define LOCK lock_t l(m());
-#define PIMPL Private::FileStream* p(static_cast<Private::FileStream*>(this->p));
-
-size_t System::IO::Private::FileStream::ReferenceCount() const
-{
-   LOCK
-   return referenceCount;
-}
+#define PIMPL Private::FileStream* p(this->p.Get());
 
 FileStream::FileStream()
   : p(new Private::FileStream)
-{
-   LOCK
-   PIMPL
-   p->referenceCount++;
-}
-
-FileStream::~FileStream()
-{
-   LOCK
-   PIMPL
-   p->referenceCount--;
-   if(!p->referenceCount)
-      delete p;
-}
-
-FileStream::FileStream(const FileStream& src)
-  : p(src.p)
-{
-   LOCK
-   PIMPL
-   p->referenceCount++;
-}
-
-FileStream& FileStream::operator =(const FileStream& src)
-{
-   if(this==&src)
-      return *this;
-
-   LOCK
-   {
-      PIMPL
-      p->referenceCount--;
-      if(!p->referenceCount)
-         delete p;
-   }
-
-   this->p = src.p;
-   PIMPL
-   p->referenceCount++;
-
-   return *this;
-}
+{}
 
 size_t FileStream::HashCode() const
 {
-   PIMPL
-   return (size_t)p;
+   return p.HashCode();
 }
 
 void FileStream::Open(String fileName, OpenMode openMode)
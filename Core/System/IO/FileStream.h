@@ -26,6 +26,7 @@
 #pragma once
 
 #include <System/Object.h>
+#include <System/SharedPimpl.h>
 #include <System/String.h>
 #include <System/Buffer.h>
 #include <System/IO/FileMode.h>
@@ -34,13 +35,12 @@ namespace System
 {
    namespace IO
    {
+      namespace Private { class FileStream; }
+
       class FileStream : public Object
       {
       public:
          FileStream();
-         virtual ~FileStream();
-         FileStream(const FileStream& src);
-         FileStream& operator =(const FileStream& src);
 
          size_t HashCode() const;
 
@@ -60,7 +60,7 @@ namespace System
          void SeekWrite(System::Int64 position);
 
       private:
-         Pimpl* p;
+         SharedHandle<Private::FileStream> p;
       };
    }
 }
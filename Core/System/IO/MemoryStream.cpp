@@ -25,25 +25,18 @@
 
 #include <System/IO/MemoryStream.h>
 
-#include <boost/thread/mutex.hpp>
-typedef boost::lock_guard<boost::mutex> lock_t;
-
 namespace System
 {
    namespace IO
    {
       namespace Private
       {
-         class MemoryStream : public System::Pimpl
+         class MemoryStream : public System::SharedPimpl
          {
          public:
             MemoryStream()
-               : referenceCount(0)
             {}
 
-            size_t ReferenceCount() const;
-
-            int referenceCount;
          };
       }
    }
@@ -51,66 +44,13 @@ namespace System
 
 using namespace System::IO;
 
-static boost::mutex& m(){
-   static boost::mutex mtx;
-   return mtx;
-}
-#define LOCK lock_t l(m());
-#define PIMPL Private::MemoryStream* p(static_cast<Private::MemoryStream*>(this->p));
-
-size_t Private::MemoryStream::ReferenceCount() const
-{
-   LOCK
-   return referenceCount;
-}
+#define PIMPL Private::MemoryStream* p(this->p.Get());
 
 MemoryStream::MemoryStream()
   : p(new Private::MemoryStream)
-{
-   LOCK
-   PIMPL
-   p->referenceCount++;
-}
-
-MemoryStream::~MemoryStream()
-{
-   LOCK
-   PIMPL
-   p->referenceCount--;
-   if(!p->referenceCount)
-      delete p;
-}
-
-MemoryStream::MemoryStream(const MemoryStream& src)
-  : p(src.p)
-{
-   LOCK
-   PIMPL
-   p->referenceCount++;
-}
-
-MemoryStream& MemoryStream::operator =(const MemoryStream& src)
-{
-   if(this==&src)
-      return *this;
-
-   LOCK
-   {
-      PIMPL
-      p->referenceCount--;
-      if(!p->referenceCount)
-         delete p;
-   }
-
-   this->p = src.p;
-   PIMPL
-   p->referenceCount++;
-
-   return *this;
-}
+{}
 
 size_t MemoryStream::HashCode() const
 {
-   PIMPL
-   return (size_t)p;
+   return p.HashCode();
 }
@@ -26,23 +26,23 @@
 #pragma once
 
 #include <System/Object.h>
+#include <System/SharedPimpl.h>
 
 namespace System
 {
    namespace IO
    {
+      namespace Private { class MemoryStream; }
+
       class MemoryStream : public Object
       {
       public:
          MemoryStream();
-         virtual ~MemoryStream();
-         MemoryStream(const MemoryStream& src);
-         MemoryStream& operator =(const MemoryStream& src);
 
          size_t HashCode() const;
 
       private:
-         Pimpl* p;
+         SharedHandle<Private::MemoryStream> p;
       };
    }
 }
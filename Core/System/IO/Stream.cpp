@@ -25,25 +25,18 @@
 
 #include <System/IO/Stream.h>
 
-#include <boost/thread/mutex.hpp>
-typedef boost::lock_guard<boost::mutex> lock_t;
-
 namespace System
 {
    namespace IO
    {
       namespace Private
       {
-         class Stream : public System::Pimpl
+         class Stream : public System::SharedPimpl
          {
          public:
             Stream()
-               : referenceCount(0)
             {}
 
-            size_t ReferenceCount() const;
-
-            int referenceCount;
          };
       }
    }
@@ -51,66 +44,13 @@ namespace System
 
 using namespace System::IO;
 
-static boost::mutex& m(){
-   static boost::mutex mtx;
-   return mtx;
-}
-#define LOCK lock_t l(m());
-#define PIMPL Private::Stream* p(static_cast<Private::Stream*>(this->p));
-
-size_t Private::Stream::ReferenceCount() const
-{
-   LOCK
-   return referenceCount;
-}
+#define PIMPL Private::Stream* p(this->p.Get());
 
 Stream::Stream()
   : p(new Private::Stream)
-{
-   LOCK
-   PIMPL
-   p->referenceCount++;
-}
-
-Stream::~Stream()
-{
-   LOCK
-   PIMPL
-   p->referenceCount--;
-   if(!p->referenceCount)
-      delete p;
-}
-
-Stream::Stream(const Stream& src)
-  : p(src.p)
-{
-   LOCK
-   PIMPL
-   p->referenceCount++;
-}
-
-Stream& Stream::operator =(const Stream& src)
-{
-   if(this==&src)
-      return *this;
-
-   LOCK
-   {
-      PIMPL
-      p->referenceCount--;
-      if(!p->referenceCount)
-         delete p;
-   }
-
-   this->p = src.p;
-   PIMPL
-   p->referenceCount++;
-
-   return *this;
-}
+{}
 
 size_t Stream::HashCode() const
 {
-   PIMPL
-   return (size_t)p;
+   return p.HashCode();
 }
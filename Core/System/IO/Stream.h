@@ -26,23 +26,23 @@
 #pragma once
 
 #include <System/Object.h>
+#include <System/SharedPimpl.h>
 
 namespace System
 {
    namespace IO
    {
+      namespace Private { class Stream; }
+
       class Stream : public Object
       {
       public:
          Stream();
-         virtual ~Stream();
-         Stream(const Stream& src);
-         Stream& operator =(const Stream& src);
 
          size_t HashCode() const;
 
       private:
-         Pimpl* p;
+         SharedHandle<Private::Stream> p;
       };
    }
 }
@@ -0,0 +1,228 @@
+/**
+ * Copyright (c) 2011 Michel Foucault
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include <System/Memory/Epoch.h>
+
+#include <set>
+#include <vector>
+
+#include <boost/atomic.hpp>
+#include <boost/thread/mutex.hpp>
+typedef boost::lock_guard<boost::mutex> lock_t;
+
+using namespace System;
+using namespace System::Memory;
+
+namespace
+{
+   const Int64 Quiescent = -1;
+   const size_t CollectInterval = 64; // retired objects between two collections of a thread
+
+   struct Retired
+   {
+      void* object;
+      Epoch::Deleter* deleter;
+      Int64 epoch;
+   };
+
+   typedef std::vector<Retired> RetiredList;
+
+   // frees the objects retired two epochs ago or earlier, keeps the others
+   Int64 Free(RetiredList& retired, Int64 epoch)
+   {
+      size_t kept(0);
+      for(size_t i=0; i<retired.size(); i++)
+      {
+         if(retired[i].epoch+2<=epoch)
+            retired[i].deleter(retired[i].object);
+         else
+            retired[kept++] = retired[i];
+      }
+
+      const Int64 freed(retired.size()-kept);
+      retired.resize(kept);
+      return freed;
+   }
+
+   boost::atomic<Int64> globalEpoch(0);
+   boost::atomic<Int64> pending(0);
+
+   class ThreadRecord
+   {
+   public:
+      ThreadRecord()
+         : epoch(Quiescent)
+         , depth(0)
+      {}
+
+      // the epoch this thread is pinned at, Quiescent outside of guards
+      boost::atomic<Int64> epoch;
+      size_t depth;
+      RetiredList retired;
+   };
+
+   // Live thread records, and the objects left behind by threads which have exited
+   class Registry
+   {
+   public:
+      void Add(ThreadRecord* record)
+      {
+         lock_t lock(mutex);
+         records.insert(record);
+      }
+
+      void Remove(ThreadRecord* record)
+      {
+         lock_t lock(mutex);
+         records.erase(record);
+         orphans.insert(orphans.end(), record->retired.begin(), record->retired.end());
+      }
+
+      void Orphan(const Retired& retired)
+      {
+         lock_t lock(mutex);
+         orphans.push_back(retired);
+      }
+
+      // the global epoch moves on once every pinned thread has seen it
+      Int64 TryAdvance()
+      {
+         lock_t lock(mutex);
+         Int64 epoch(globalEpoch.load());
+         boost::atomic_thread_fence(boost::memory_order_seq_cst);
+
+         for(std::set<ThreadRecord*>::const_iterator it(records.begin()); it!=records.end(); ++it)
+         {
+            // acquire: the reads of the guards a thread has left happen before what we free
+            const Int64 pinned((*it)->epoch.load(boost::memory_order_acquire));
+            if(pinned!=Quiescent && pinned!=epoch)
+               return epoch;
+         }
+
+         if(globalEpoch.compare_exchange_strong(epoch, epoch+1))
+            epoch++;
+
+         pending.fetch_sub(Free(orphans, epoch));
+         return epoch;
+      }
+
+   private:
+      boost::mutex mutex;
+      std::set<ThreadRecord*> records;
+      RetiredList orphans;
+   };
+
+   // never destroyed, objects retired by static destructors still find it
+   Registry& registry()
+   {
+      static Registry* registry(new Registry);
+      return *registry;
+   }
+
+   thread_local ThreadRecord* threadRecord = NULL;
+   thread_local bool threadRecordReleased = false;
+
+   // Destroyed at thread exit: what the thread retired is left to the registry
+   class ThreadRecordOwner
+   {
+   public:
+      void Adopt(ThreadRecord* record) { threadRecord = record; }
+
+      ~ThreadRecordOwner()
+      {
+         if(!threadRecord)
+            return;
+
+         registry().Remove(threadRecord);
+         delete threadRecord;
+         threadRecord = NULL;
+         threadRecordReleased = true;
+      }
+   };
+
+   thread_local ThreadRecordOwner threadRecordOwner;
+
+   ThreadRecord* Record()
+   {
+      if(threadRecord || threadRecordReleased)
+         return threadRecord;
+
+      ThreadRecord* record(new ThreadRecord);
+      registry().Add(record);
+      threadRecordOwner.Adopt(record);
+      return record;
+   }
+}
+
+void Epoch::Enter()
+{
+   ThreadRecord* record(Record());
+   if(!record || record->depth++)
+      return;
+
+   // the pin must be visible before the guarded reads, see Registry::TryAdvance
+   record->epoch.store(globalEpoch.load(boost::memory_order_relaxed), boost::memory_order_release);
+   boost::atomic_thread_fence(boost::memory_order_seq_cst);
+}
+
+void Epoch::Exit()
+{
+   ThreadRecord* record(threadRecord);
+   if(!record || --record->depth)
+      return;
+
+   record->epoch.store(Quiescent, boost::memory_order_release);
+}
+
+void Epoch::Retire(void* object, Deleter* deleter)
+{
+   // the unlinking store must be visible before the epoch is read: a reader which still finds
+   // the object is then pinned at an epoch no older than the one the object is tagged with
+   boost::atomic_thread_fence(boost::memory_order_seq_cst);
+   Retired retired = { object, deleter, globalEpoch.load(boost::memory_order_relaxed) };
+   pending.fetch_add(1, boost::memory_order_relaxed);
+
+   ThreadRecord* record(Record());
+   if(!record)
+   {
+      registry().Orphan(retired);
+      return;
+   }
+
+   record->retired.push_back(retired);
+   if(record->retired.size()%CollectInterval==0)
+      Collect();
+}
+
+void Epoch::Collect()
+{
+   const Int64 epoch(registry().TryAdvance());
+   if(ThreadRecord* record = threadRecord)
+      pending.fetch_sub(Free(record->retired, epoch));
+}
+
+Int64 Epoch::Pending()
+{
+   return pending.load(boost::memory_order_relaxed);
+}
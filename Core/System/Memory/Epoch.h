@@ -0,0 +1,83 @@
+/**
+ * Copyright (c) 2011 Michel Foucault
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+#pragma once
+
+#include <Config.h>
+
+#include <cstddef>
+
+namespace System
+{
+   namespace Memory
+   {
+      // Epoch-based reclamation for lock-free readers. A reader pins the current epoch with a
+      // Guard while it follows shared pointers; a writer unlinks an object and retires it, and
+      // the object is freed once every thread pinned at that time has left its guard.
+      class Epoch
+      {
+      public:
+         // Pins the calling thread for its lifetime, guards nest
+         class Guard
+         {
+         public:
+            Guard() { Epoch::Enter(); }
+            ~Guard() { Epoch::Exit(); }
+
+         private:
+            Guard(const Guard&);
+            Guard& operator =(const Guard&);
+         };
+
+         typedef void Deleter(void* object);
+
+         static void Enter();
+         static void Exit();
+
+         // Free object with deleter once no pinned thread can still reach it; the object must
+         // already be unreachable for threads entering a guard from now on
+         static void Retire(void* object, Deleter* deleter);
+
+         template<class T>
+         static void Retire(T* object)
+         {
+            Retire(object, &Delete<T>);
+         }
+
+         // Try to advance the epoch and free what the calling thread retired, Retire does it
+         // on its own every few objects
+         static void Collect();
+
+         // Objects retired and not freed yet, across all threads
+         static Int64 Pending();
+
+      private:
+         template<class T>
+         static void Delete(void* object)
+         {
+            delete static_cast<T*>(object);
+         }
+      };
+   }
+}
@@ -0,0 +1,278 @@
+/**
+ * Copyright (c) 2011 Michel Foucault
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <System/Memory/Pool.h>
+#include <System/Object.h>
+
+#include <new>
+#include <set>
+
+#include <boost/atomic.hpp>
+#include <boost/thread/mutex.hpp>
+typedef boost::lock_guard<boost::mutex> lock_t;
+
+using namespace System;
+using namespace System::Memory;
+
+namespace
+{
+   const size_t ClassCount = Pool::MaxBlockSize/Pool::Granularity;
+   const size_t MaxFreeBlocks = 256; // per size class and per thread
+
+   size_t ClassIndex(size_t size) { return size ? (size-1)/Pool::Granularity : 0; }
+   size_t ClassSize(size_t index) { return (index+1)*Pool::Granularity; }
+
+   struct FreeBlock
+   {
+      FreeBlock* next;
+   };
+
+   typedef boost::atomic<Int64> Counter;
+
+   // counters are written by their owner thread only and read by Statistics()
+   void Bump(Counter& counter, Int64 delta)
+   {
+      counter.store(counter.load(boost::memory_order_relaxed)+delta, boost::memory_order_relaxed);
+   }
+
+   struct Counters
+   {
+      Counters()
+         : allocations(0)
+         , hits(0)
+         , deallocations(0)
+         , oversized(0)
+         , bytesRetained(0)
+      {}
+
+      void AddTo(PoolStatistics& stats) const
+      {
+         stats.Allocations += allocations.load(boost::memory_order_relaxed);
+         stats.Hits += hits.load(boost::memory_order_relaxed);
+         stats.Deallocations += deallocations.load(boost::memory_order_relaxed);
+         stats.Oversized += oversized.load(boost::memory_order_relaxed);
+         stats.BytesRetained += bytesRetained.load(boost::memory_order_relaxed);
+      }
+
+      Counter allocations;
+      Counter hits;
+      Counter deallocations;
+      Counter oversized;
+      Counter bytesRetained;
+   };
+
+   class ThreadCache
+   {
+   public:
+      ThreadCache()
+      {
+         for(size_t i=0; i<ClassCount; i++)
+         {
+            lists[i] = NULL;
+            lengths[i] = 0;
+         }
+      }
+
+      void* Pop(size_t index)
+      {
+         FreeBlock* block(lists[index]);
+         if(!block)
+            return NULL;
+
+         lists[index] = block->next;
+         lengths[index]--;
+         Bump(counters.bytesRetained, -(Int64)ClassSize(index));
+         return block;
+      }
+
+      bool Push(void* block, size_t index)
+      {
+         if(lengths[index]>=MaxFreeBlocks)
+            return false;
+
+         FreeBlock* freeBlock(static_cast<FreeBlock*>(block));
+         freeBlock->next = lists[index];
+         lists[index] = freeBlock;
+         lengths[index]++;
+         Bump(counters.bytesRetained, ClassSize(index));
+         return true;
+      }
+
+      void Trim()
+      {
+         for(size_t i=0; i<ClassCount; i++)
+         {
+            while(void* block = Pop(i))
+               ::operator delete(block);
+         }
+      }
+
+      Counters counters;
+
+   private:
+      FreeBlock* lists[ClassCount];
+      size_t lengths[ClassCount];
+   };
+
+   // Live thread caches, and the counters of the caches whose thread has exited
+   class Registry
+   {
+   public:
+      void Add(ThreadCache* cache)
+      {
+         lock_t lock(mutex);
+         caches.insert(cache);
+      }
+
+      void Remove(ThreadCache* cache)
+      {
+         lock_t lock(mutex);
+         caches.erase(cache);
+         retired.allocations.fetch_add(cache->counters.allocations);
+         retired.hits.fetch_add(cache->counters.hits);
+         retired.deallocations.fetch_add(cache->counters.deallocations);
+         retired.oversized.fetch_add(cache->counters.oversized);
+      }
+
+      PoolStatistics Statistics()
+      {
+         lock_t lock(mutex);
+         PoolStatistics stats;
+         retired.AddTo(stats);
+         for(std::set<ThreadCache*>::const_iterator it(caches.begin()); it!=caches.end(); ++it)
+            (*it)->counters.AddTo(stats);
+         return stats;
+      }
+
+   private:
+      boost::mutex mutex;
+      std::set<ThreadCache*> caches;
+      Counters retired;
+   };
+
+   // never destroyed: pimpls owned by static objects are freed after every other static
+   Registry& registry()
+   {
+      static Registry* registry(new Registry);
+      return *registry;
+   }
+
+   thread_local ThreadCache* threadCache = NULL;
+   thread_local bool threadCacheReleased = false;
+
+   // Destroyed at thread exit: hands the free blocks back and retires the counters.
+   // Blocks freed later on this thread bypass the pool.
+   class ThreadCacheOwner
+   {
+   public:
+      void Adopt(ThreadCache* cache) { threadCache = cache; }
+
+      ~ThreadCacheOwner()
+      {
+         if(!threadCache)
+            return;
+
+         threadCache->Trim();
+         registry().Remove(threadCache);
+         delete threadCache;
+         threadCache = NULL;
+         threadCacheReleased = true;
+      }
+   };
+
+   thread_local ThreadCacheOwner threadCacheOwner;
+
+   ThreadCache* Cache()
+   {
+      if(threadCache || threadCacheReleased)
+         return threadCache;
+
+      ThreadCache* cache(new ThreadCache);
+      registry().Add(cache);
+      threadCacheOwner.Adopt(cache);
+      return cache;
+   }
+}
+
+void* Pool::Allocate(size_t size)
+{
+   ThreadCache* cache(Cache());
+
+   if(size>MaxBlockSize)
+   {
+      if(cache)
+         Bump(cache->counters.oversized, 1);
+      return ::operator new(size);
+   }
+
+   const size_t index(ClassIndex(size));
+   if(cache)
+   {
+      Bump(cache->counters.allocations, 1);
+      if(void* block = cache->Pop(index))
+      {
+         Bump(cache->counters.hits, 1);
+         return block;
+      }
+   }
+
+   return ::operator new(ClassSize(index));
+}
+
+void Pool::Deallocate(void* block, size_t size)
+{
+   if(!block)
+      return;
+
+   ThreadCache* cache(Cache());
+   if(size<=MaxBlockSize && cache && cache->Push(block, ClassIndex(size)))
+   {
+      Bump(cache->counters.deallocations, 1);
+      return;
+   }
+
+   ::operator delete(block);
+}
+
+void Pool::Trim()
+{
+   if(ThreadCache* cache = Cache())
+      cache->Trim();
+}
+
+PoolStatistics Pool::Statistics()
+{
+   return registry().Statistics();
+}
+
+void* Pimpl::operator new(size_t size)
+{
+   return Pool::Allocate(size);
+}
+
+void Pimpl::operator delete(void* block, size_t size)
+{
+   Pool::Deallocate(block, size);
+}
@@ -0,0 +1,71 @@
+/**
+ * Copyright (c) 2011 Michel Foucault
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <Config.h>
+
+namespace System
+{
+   namespace Memory
+   {
+      struct PoolStatistics
+      {
+         PoolStatistics()
+            : Allocations(0)
+            , Hits(0)
+            , Deallocations(0)
+            , Oversized(0)
+            , BytesRetained(0)
+         {}
+
+         double HitRate() const { return Allocations ? (double)Hits/Allocations : 0.0; }
+
+         Int64 Allocations;   // requests that fit a size class
+         Int64 Hits;          // of which served from a thread-local free list
+         Int64 Deallocations; // blocks handed back to a free list
+         Int64 Oversized;     // requests larger than MaxBlockSize, forwarded to operator new
+         Int64 BytesRetained; // bytes currently parked in free lists
+      };
+
+      // Size-class allocator for small, short-lived framework objects (pimpls, ObjectRef
+      // control blocks). Each thread keeps its own free lists, so a block freed on one
+      // thread is reused by the next allocation of the same size class on that thread.
+      class Pool
+      {
+      public:
+         static const size_t Granularity = 16;
+         static const size_t MaxBlockSize = 256;
+
+         static void* Allocate(size_t size);
+         static void Deallocate(void* block, size_t size);
+
+         // Give the calling thread's free blocks back to the system allocator
+         static void Trim();
+
+         static PoolStatistics Statistics();
+      };
+   }
+}
@@ -37,6 +37,10 @@ namespace System
       virtual ~Object() {};
 
       virtual size_t HashCode() const = 0;
+      // Equal objects have equal hash codes. By default objects of one type are equal when their
+      // hash codes are, which is identity for the handle types hashing their pimpl; types whose
+      // hash codes may collide override it.
+      virtual bool Equals(const Object& other) const;
       virtual System::Type& Type() const;
       virtual std::string ToString() const;
    };
@@ -46,5 +50,9 @@ namespace System
    public:
       virtual ~Pimpl() {};
       virtual size_t ReferenceCount() const = 0;
+
+      // pimpls are small and short-lived, they come from the thread-local Memory::Pool
+      static void* operator new(size_t size);
+      static void operator delete(void* block, size_t size);
    };
 }
@@ -26,81 +26,79 @@
 #include <System/ObjectRef.h>
 #include <System/Exception.h>
 
-#include <boost/thread/recursive_mutex.hpp>
-typedef boost::lock_guard<boost::recursive_mutex> lock_t;
-
 namespace System
 {
    namespace Private
    {
-      class ObjectRef : public System::Pimpl
+      // Block owning an object allocated apart, see ObjectRef(Object*)
+      class ObjectRef : public Detail::ObjectBlock
       {
       public:
-         ObjectRef()
-            : referenceCount(0)
-            , object(0)
-         {}
+         ObjectRef(Object* object)
+         {
+            this->object = object;
+            value = dynamic_cast<void*>(object);
+            typeId = &typeid(*object);
+         }
 
          ~ObjectRef()
          {
-            delete object;
+            Dispose();
          }
 
-         size_t ReferenceCount() const;
-
-         void Reset()
+         void Dispose()
          {
             delete object;
             object = NULL;
          }
-
-         int referenceCount;
-         Object* object;
       };
    }
 }
 
 using namespace System;
 
-static boost::recursive_mutex& m(){
-   static boost::recursive_mutex mtx;
-   return mtx;
-}
-#define LOCK lock_t l(m());
-#define PIMPL Private::ObjectRef* p(static_cast<Private::ObjectRef*>(this->p));
-
-size_t Private::ObjectRef::ReferenceCount() const
-{
-   LOCK
-   return referenceCount;
-}
+#define PIMPL Detail::ObjectBlock* p(this->p);
 
 ObjectRef::ObjectRef(Object* object)
-  : p(new Private::ObjectRef)
+  : p(NULL)
 {
    if(!object)
       throw NullPointerException();
-   LOCK
-   PIMPL
-   p->referenceCount++;
-   p->object = object;
+
+   this->p = new Private::ObjectRef(object);
+   if(Diagnostics::Detail::IsEnabled())
+      p->Track(Diagnostics::Detail::Counters(typeid(*object)));
+   p->AddReference();
+}
+
+ObjectRef::ObjectRef(Detail::ObjectBlock* block)
+  : p(block)
+{
+   p->AddReference();
 }
 
 ObjectRef::~ObjectRef()
 {
-   LOCK
-   PIMPL
-   p->referenceCount--;
-   if(!p->referenceCount)
-      delete p;
+   Detail::ObjectBlock::Release(p);
 }
 
 ObjectRef::ObjectRef(const ObjectRef& src)
   : p(src.p)
 {
-   LOCK
-   PIMPL
-   p->referenceCount++;
+   if(p)
+      p->AddReference();
+}
+
+ObjectRef& ObjectRef::operator =(ObjectRef&& src) noexcept
+{
+   if(this==&src)
+      return *this;
+
+   Detail::ObjectBlock::Release(p);
+   this->p = src.p;
+   src.p = NULL;
+
+   return *this;
 }
 
 ObjectRef& ObjectRef::operator =(const ObjectRef& src)
@@ -108,17 +106,11 @@ ObjectRef& ObjectRef::operator =(const ObjectRef& src)
    if(this==&src)
       return *this;
 
-   LOCK
-   {
-      PIMPL
-      p->referenceCount--;
-      if(!p->referenceCount)
-         delete p;
-   }
+   if(src.p)
+      src.p->AddReference();
+   Detail::ObjectBlock::Release(p);
 
    this->p = src.p;
-   PIMPL
-   p->referenceCount++;
 
    return *this;
 }
@@ -126,16 +118,27 @@ ObjectRef& ObjectRef::operator =(const ObjectRef& src)
 size_t ObjectRef::HashCode() const
 {
    PIMPL
-   if(!p->object)
+   if(!p || !p->object)
       return (size_t)p;
 
    return p->object->HashCode();
 }
 
+bool ObjectRef::Equals(const Object& other) const
+{
+   PIMPL
+   const ObjectRef* ref(dynamic_cast<const ObjectRef*>(&other));
+   if(!p || !p->object)
+      return ref && (!ref->p || !ref->p->object);
+   if(ref)
+      return ref->p && ref->p->object && p->object->Equals(*ref->p->object);
+   return p->object->Equals(other);
+}
+
 System::Type& ObjectRef::Type() const
 {
    PIMPL
-   if(!p->object)
+   if(!p || !p->object)
       return Object::Type();
 
    return p->object->Type();
@@ -144,7 +147,7 @@ System::Type& ObjectRef::Type() const
 std::string ObjectRef::ToString() const
 {
    PIMPL
-   if(!p->object)
+   if(!p || !p->object)
       return Object::ToString();
 
    return p->object->ToString();
@@ -153,19 +156,20 @@ std::string ObjectRef::ToString() const
 void ObjectRef::Reset()
 {
    PIMPL
-   return p->Reset();
+   if(p)
+      p->Dispose();
 }
 
 ObjectRef::operator bool() const
 {
    PIMPL
-   return p->object!=NULL;
+   return p && p->object!=NULL;
 }
 
 Object& ObjectRef::Get()
 {
    PIMPL
-   if(!p->object)
+   if(!p || !p->object)
       throw NullPointerException();
    return *p->object;
 }
@@ -173,7 +177,7 @@ Object& ObjectRef::Get()
 const Object& ObjectRef::Get() const
 {
    PIMPL
-   if(!p->object)
+   if(!p || !p->object)
       throw NullPointerException();
    return *p->object;
 }
@@ -26,25 +26,137 @@
 #pragma once
 
 #include <System/Object.h>
+#include <System/SharedPimpl.h>
+
+#include <algorithm>
+#include <new>
+#include <typeinfo>
+#include <utility>
+
+#include <boost/type_traits/aligned_storage.hpp>
+#include <boost/type_traits/alignment_of.hpp>
 
 namespace System
 {
+   namespace Detail
+   {
+      // ObjectRef control block: the reference counts and the referenced object,
+      // with its exact type and complete-object address for RTTI-free casts.
+      // The strong references share one weak reference, the last strong one disposes
+      // the object and the last weak one deletes the block.
+      class ObjectBlock : public SharedPimpl
+      {
+      public:
+         ObjectBlock()
+            : object(NULL)
+            , value(NULL)
+            , typeId(NULL)
+            , weakCount(1)
+         {}
+
+         // Destroy the object, the block stays alive for the remaining references
+         virtual void Dispose() = 0;
+
+         void AddWeakReference()
+         {
+            weakCount.fetch_add(1, boost::memory_order_relaxed);
+         }
+
+         bool RemoveWeakReference()
+         {
+            if(weakCount.fetch_sub(1, boost::memory_order_release)!=1)
+               return false;
+
+            boost::atomic_thread_fence(boost::memory_order_acquire);
+            return true;
+         }
+
+         // drop a strong reference, the block is deleted with the last reference of either kind
+         static void Release(ObjectBlock* block)
+         {
+            if(!block || !block->RemoveReference())
+               return;
+
+            block->Dispose();
+            if(block->RemoveWeakReference())
+               delete block;
+         }
+
+         Object* object;
+         void* value;
+         const std::type_info* typeId;
+
+      private:
+         boost::atomic<int> weakCount;
+      };
+
+      // Control block and object in one allocation, see ObjectRef::Make
+      template<class T>
+      class ObjectHolder : public ObjectBlock
+      {
+      public:
+         template<class... Args>
+         explicit ObjectHolder(Args&&... args)
+         {
+            T* t(new(&storage) T(std::forward<Args>(args)...));
+            object = t;
+            value = t;
+            typeId = &typeid(T);
+         }
+
+         ~ObjectHolder()
+         {
+            Dispose();
+         }
+
+         void Dispose()
+         {
+            if(!object)
+               return;
+
+            reinterpret_cast<T*>(&storage)->~T();
+            object = NULL;
+         }
+
+      private:
+         typename boost::aligned_storage<sizeof(T), boost::alignment_of<T>::value>::type storage;
+      };
+   }
+
    class ObjectRef : public Object
    {
    public:
+      // Construct a T and its control block in a single allocation
+      template<class T, class... Args>
+      static ObjectRef Make(Args&&... args)
+      {
+         Detail::ObjectHolder<T>* block(new Detail::ObjectHolder<T>(std::forward<Args>(args)...));
+         if(Diagnostics::Detail::IsEnabled())
+            block->Track(Diagnostics::Detail::CountersOf<T>());
+         return ObjectRef(block);
+      }
+
       template<class T>
-      static ObjectRef Create() { return ObjectRef(new T); }
+      static ObjectRef Create() { return Make<T>(); }
       template<class T>
-      static ObjectRef Create(const T& t) { return ObjectRef(new T(t)); }
+      static ObjectRef Create(const T& t) { return Make<T>(t); }
 
+      // empty reference, see WeakObjectRef::Lock
+      ObjectRef() : p(NULL) {}
       ObjectRef(Object* object);
       virtual ~ObjectRef();
       ObjectRef(const ObjectRef& src);
       ObjectRef& operator =(const ObjectRef& src);
 
+      // a moved-from ObjectRef is empty, as a default constructed one
+      ObjectRef(ObjectRef&& src) noexcept : p(src.p) { src.p = NULL; }
+      ObjectRef& operator =(ObjectRef&& src) noexcept;
+
       void Reset();
 
       size_t HashCode() const;
+      // compares the referenced objects, other may be an ObjectRef or the object itself
+      bool Equals(const Object& other) const;
       System::Type& Type() const;
       std::string ToString() const;
 
@@ -56,16 +168,55 @@ namespace System
       operator Object& () { return Get(); }
       operator const Object& () const { return Get(); }
 
+      // exact type matches are a pointer compare, base class queries fall back to dynamic_cast
       template<class T>
-      T& Get() { return dynamic_cast<T&>(Get()); }
+      T& Get()
+      {
+         if(T* t = ExactCast<T>())
+            return *t;
+         return dynamic_cast<T&>(Get());
+      }
 
       template<class T>
-      const T& Get() const { return dynamic_cast<const T&>(Get()); }
+      const T& Get() const
+      {
+         if(const T* t = ExactCast<T>())
+            return *t;
+         return dynamic_cast<const T&>(Get());
+      }
 
       template<class T>
-      bool IsTypeOf() const { return dynamic_cast<const T*>(&Get())!=NULL; }
+      bool IsTypeOf() const { return As<T>()!=NULL; }
+
+      // the referenced object as T, or NULL when it is empty or of another type
+      template<class T>
+      T* As()
+      {
+         if(T* t = ExactCast<T>())
+            return t;
+         return p && p->object ? dynamic_cast<T*>(p->object) : NULL;
+      }
+
+      template<class T>
+      const T* As() const
+      {
+         if(const T* t = ExactCast<T>())
+            return t;
+         return p && p->object ? dynamic_cast<const T*>(p->object) : NULL;
+      }
 
    private:
-      Pimpl* p;
+      friend class WeakObjectRef;
+      explicit ObjectRef(Detail::ObjectBlock* block);
+
+      template<class T>
+      T* ExactCast() const
+      {
+         if(!p || !p->object || p->typeId!=&typeid(T))
+            return NULL;
+         return static_cast<T*>(p->value);
+      }
+
+      Detail::ObjectBlock* p;
    };
 }
@@ -30,21 +30,17 @@
 #include <cmath>
 #include <limits>
 
-#include <boost/thread/mutex.hpp>
-typedef boost::lock_guard<boost::mutex> lock_t;
-
 namespace System
 {
    namespace Private
    {
       byte_array& BufferInternalField(const System::Buffer& buffer);
 
-      class Random : public System::Pimpl
+      class Random : public System::SharedPimpl
       {
       public:
          Random()
-            : referenceCount(0)
-            , syncRoot()
+            : syncRoot()
             , rng()
             , randInt(std::numeric_limits<int>::min(), std::numeric_limits<int>::max())
             , randDouble()
@@ -52,16 +48,13 @@ namespace System
          {}
 
          Random(int min, int max)
-            : referenceCount(0)
-            , syncRoot()
+            : syncRoot()
             , rng()
             , randInt(std::min(min, max), std::max(min,max))
             , randDouble()
             , randBytes(0x00, 0xFF)
          {}
 
-         size_t ReferenceCount() const;
-
          int Next()
          {
             Threading::Locker lock(syncRoot);
@@ -73,7 +66,7 @@ namespace System
             Threading::Locker lock(syncRoot);
             return randDouble(rng);
          }
-         void NextBytes(Buffer& buffer)
+         void NextBytes(System::Buffer& buffer)
          {
             Threading::Locker lock(syncRoot);
             byte_array& bytes(BufferInternalField(buffer));
@@ -82,7 +75,6 @@ namespace System
                *it++ = (byte)randBytes(rng);
          }
 
-         int referenceCount;
          Threading::Synchro syncRoot;
 
          boost::mt19937 rng;
@@ -95,76 +87,19 @@ namespace System
 
 using namespace System;
 
-static boost::mutex& m(){
-   static boost::mutex mtx;
-   return mtx;
-}
-#define LOCK lock_t l(m());
-#define PIMPL Private::Random* p(static_cast<Private::Random*>(this->p));
-
-size_t Private::Random::ReferenceCount() const
-{
-   LOCK
-   return referenceCount;
-}
+#define PIMPL Private::Random* p(this->p.Get());
 
 Random::Random()
   : p(new Private::Random)
-{
-   LOCK
-   PIMPL
-   p->referenceCount++;
-}
-
-Random::~Random()
-{
-   LOCK
-   PIMPL
-   p->referenceCount--;
-   if(!p->referenceCount)
-      delete p;
-}
+{}
 
 Random::Random(int min, int max)
    : p(new Private::Random(min, max))
-{
-   LOCK
-   PIMPL
-   p->referenceCount++;
-}
-
-Random::Random(const Random& src)
-  : p(src.p)
-{
-   LOCK
-   PIMPL
-   p->referenceCount++;
-}
-
-Random& Random::operator =(const Random& src)
-{
-   if(this==&src)
-      return *this;
-
-   LOCK
-   {
-      PIMPL
-      p->referenceCount--;
-      if(!p->referenceCount)
-         delete p;
-   }
-
-   this->p = src.p;
-   PIMPL
-   p->referenceCount++;
-
-   return *this;
-}
+{}
 
 size_t Random::HashCode() const
 {
-   PIMPL
-   return (size_t)p;
+   return p.HashCode();
 }
 
 int Random::Next() const
@@ -26,18 +26,18 @@
 #pragma once
 
 #include <System/Object.h>
+#include <System/SharedPimpl.h>
 #include <System/Buffer.h>
 
 namespace System
 {
+   namespace Private { class Random; }
+
    class Random : public Object
    {
    public:
       Random();
       Random(int min, int max);
-      virtual ~Random();
-      Random(const Random& src);
-      Random& operator =(const Random& src);
 
       size_t HashCode() const;
 
@@ -47,6 +47,6 @@ namespace System
       Buffer NextBytes(size_t size) const;
 
    private:
-      Pimpl* p;
+      SharedHandle<Private::Random> p;
    };
 }
@@ -0,0 +1,182 @@
+/**
+ * Copyright (c) 2011 Michel Foucault
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <System/Object.h>
+#include <System/Diagnostics/Instrumentation.h>
+
+#include <algorithm>
+#include <cassert>
+
+#include <boost/atomic.hpp>
+
+namespace System
+{
+   // Pimpl base owning the atomic intrusive reference count of every handle sharing it
+   class SharedPimpl : public Pimpl
+   {
+   public:
+      SharedPimpl()
+         : referenceCount(0)
+         , counters(NULL)
+      {}
+
+      virtual ~SharedPimpl()
+      {
+         if(counters)
+            Diagnostics::Detail::Bump(counters->live, -1);
+      }
+
+      // count this pimpl under its type, see Diagnostics::Instrumentation
+      void Track(Diagnostics::Detail::TypeCounters& typeCounters)
+      {
+         counters = &typeCounters;
+         Diagnostics::Detail::Bump(counters->live);
+         Diagnostics::Detail::Bump(counters->allocations);
+      }
+
+      size_t ReferenceCount() const
+      {
+         return referenceCount.load(boost::memory_order_relaxed);
+      }
+
+      void AddReference()
+      {
+         // a new reference is always taken from an existing one, no ordering needed
+         referenceCount.fetch_add(1, boost::memory_order_relaxed);
+         if(counters)
+            Diagnostics::Detail::Bump(counters->referenceOperations);
+      }
+
+      // take a reference only while one is still held elsewhere, for weak handles
+      bool TryAddReference()
+      {
+         int count(referenceCount.load(boost::memory_order_relaxed));
+         while(count)
+         {
+            if(referenceCount.compare_exchange_weak(count, count+1, boost::memory_order_acquire, boost::memory_order_relaxed))
+            {
+               if(counters)
+                  Diagnostics::Detail::Bump(counters->referenceOperations);
+               return true;
+            }
+         }
+         return false;
+      }
+
+      bool RemoveReference()
+      {
+         if(counters)
+            Diagnostics::Detail::Bump(counters->referenceOperations);
+
+         // release our writes to the pimpl, the last owner acquires them before deleting
+         if(referenceCount.fetch_sub(1, boost::memory_order_release)!=1)
+            return false;
+
+         boost::atomic_thread_fence(boost::memory_order_acquire);
+         return true;
+      }
+
+   private:
+      SharedPimpl(const SharedPimpl&);
+      SharedPimpl& operator =(const SharedPimpl&);
+
+      boost::atomic<int> referenceCount;
+      Diagnostics::Detail::TypeCounters* counters;
+   };
+
+   // Typed handle on a SharedPimpl: copies share the pimpl, the last one deletes it.
+   // T may be incomplete where the handle is declared, Get() is only used where T is defined.
+   template<class T>
+   class SharedHandle
+   {
+   public:
+      explicit SharedHandle(T* pimpl)
+         : p(pimpl)
+      {
+         if(Diagnostics::Detail::IsEnabled())
+            p->Track(Diagnostics::Detail::CountersOf<T>());
+         p->AddReference();
+      }
+
+      ~SharedHandle()
+      {
+         Release();
+      }
+
+      SharedHandle(const SharedHandle& src)
+         : p(src.p)
+      {
+         p->AddReference();
+      }
+
+      SharedHandle& operator =(const SharedHandle& src)
+      {
+         src.p->AddReference();
+         Release();
+         p = src.p;
+         return *this;
+      }
+
+      // Moves steal the pimpl without touching the count, move assignment first releases the old one.
+      // A moved-from handle may only be destroyed or assigned, using it otherwise trips the assert in Get().
+      SharedHandle(SharedHandle&& src) noexcept
+         : p(src.p)
+      {
+         src.p = NULL;
+      }
+
+      SharedHandle& operator =(SharedHandle&& src) noexcept
+      {
+         if(this!=&src)
+         {
+            Release();
+            p = src.p;
+            src.p = NULL;
+         }
+         return *this;
+      }
+
+      T* Get() const
+      {
+         assert(p && "moved-from handle");
+         return static_cast<T*>(p);
+      }
+
+      T* operator ->() const { return Get(); }
+
+      size_t HashCode() const { return (size_t)p; }
+
+   private:
+      void Release()
+      {
+         if(p && p->RemoveReference())
+            delete p;
+      }
+
+      SharedPimpl* p;
+   };
+}
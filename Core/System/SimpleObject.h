@@ -33,6 +33,11 @@ namespace System
    class SimpleObject : public Object
    {
    public:
+      SimpleObject() {}
+      // copies share the hash code, no move is declared so a moved-from object keeps it as well
+      SimpleObject(const SimpleObject& src) : Object(src), hashCode(src.hashCode) {}
+      SimpleObject& operator =(const SimpleObject& src) { hashCode = src.hashCode; return *this; }
+
       size_t HashCode() const { return hashCode; }
 
    private:
@@ -24,215 +24,471 @@
  */
 
 #include <System/String.h>
-#include <System/SimpleObject.h>
+#include <System/Diagnostics/Instrumentation.h>
+#include <System/StringView.h>
+#include <System/Exception.h>
 
-#include <map>
+#include <cassert>
+#include <cstring>
+#include <typeinfo>
 #include <vector>
-#include <algorithm>
-#include <boost/ptr_container/ptr_list.hpp>
-#include <iostream>
 
+#include <boost/atomic.hpp>
+#include <boost/cstdint.hpp>
 #include <boost/thread/mutex.hpp>
 typedef boost::lock_guard<boost::mutex> lock_t;
 
 typedef size_t hash_t;
-static hash_t SdbmHash(const std::string& key);
+static hash_t StringHash(const std::string& key);
 
 namespace System
 {
    namespace Private
    {
+      // also hashes StringView contents
+      size_t StringHash(const char* data, size_t size);
+
       class String : public System::Pimpl
       {
       public:
-         String()
-            : referenceCount(0)
-            , string()
-         {}
-
-         String(const std::string& string)
+         // transient pimpls are not in the intern pool, their hash is computed on first use
+         String(const std::string& string, hash_t hash, bool interned)
             : referenceCount(0)
             , string(string)
-         {}
+            , hash(hash)
+            , transientHash(0)
+            , interned(interned)
+            , internedCopy(NULL)
+            , counters(NULL)
+         {
+            Track();
+         }
 
-         size_t ReferenceCount() const;
+         ~String()
+         {
+            if(counters)
+               Diagnostics::Detail::Bump(counters->live, -1);
+         }
 
-         int referenceCount;
-         std::string string;
+         size_t ReferenceCount() const
+         {
+            return referenceCount.load(boost::memory_order_relaxed);
+         }
 
-         typedef boost::ptr_list<String> Collection;
-         typedef boost::shared_ptr<Collection> CollectionPtr;
-         typedef std::map<hash_t, CollectionPtr> Map;
-      };
+         // count this pimpl under Private::String, see Diagnostics::Instrumentation
+         void Track()
+         {
+            if(!Diagnostics::Detail::IsEnabled())
+               return;
 
-      std::string& StringInternalField(const System::String& string)
-      {
-         Private::String& p(*reinterpret_cast<Private::String*>(string.HashCode()));
-         return p.string;
-      }
+            counters = &Diagnostics::Detail::CountersOf<String>();
+            Diagnostics::Detail::Bump(counters->live);
+            Diagnostics::Detail::Bump(counters->allocations);
+         }
+
+         void CountReferenceOperation()
+         {
+            if(counters)
+               Diagnostics::Detail::Bump(counters->referenceOperations);
+         }
+
+         hash_t ContentHash()
+         {
+            if(interned)
+               return hash;
+
+            // racing threads store the same value, a zero hash is just recomputed
+            hash_t ret(transientHash.load(boost::memory_order_relaxed));
+            if(!ret)
+            {
+               ret = StringHash(string.data(), string.size());
+               transientHash.store(ret, boost::memory_order_relaxed);
+            }
+            return ret;
+         }
+
+         boost::atomic<int> referenceCount;
+         const std::string string;
+         const hash_t hash;
+         boost::atomic<hash_t> transientHash;
+         const bool interned;
+         // transient only: the interned pimpl of the same content once asked for, holds a reference on it
+         boost::atomic<String*> internedCopy;
+         Diagnostics::Detail::TypeCounters* counters;
+      };
    }
 
-   class StringFactory : public SimpleObject
+   // Intern pool sharded by hash, each shard behind its own mutex. A pimpl is looked up and
+   // its count raised under the shard lock. Copies add references without locking, and a
+   // release only locks to drop the last one, so a concurrent lookup cannot revive a dying pimpl.
+   class StringFactory
    {
    public:
-      typedef Private::String::Map PimplMap;
-      typedef Private::String::Collection PimplCollection;
-      typedef Private::String::CollectionPtr PimplCollectionPtr;
-      typedef std::vector<PimplMap> PimplMapCollection;
-
-      static PimplCollection::iterator Find(PimplCollection& pimpls, const std::string& string)
+      Private::String* Acquire(const std::string& string)
       {
-         PimplCollection::iterator it = pimpls.begin();
-         while(it != pimpls.end())
+         const hash_t hash(StringHash(string));
+         Shard& shard(ShardFromHash(hash));
+         Lock lock(shard);
+
+         Private::String* p(shard.Find(string, hash));
+         if(!p)
          {
-            PimplCollection::iterator f(it++);
-            Private::String& pimpl(*f);
-            if(pimpl.string == string)
-               return f;
+            p = new Private::String(string, hash, true);
+            shard.Insert(p);
          }
-         return pimpls.end();
+
+         AddReference(p);
+         return p;
+      }
+
+      static Private::String* AcquireTransient(const std::string& string)
+      {
+         Private::String* p(new Private::String(string, 0, false));
+         AddReference(p);
+         return p;
       }
 
-      Private::String& FromString(const std::string& string)
+      // p itself when interned, else its interned copy, looked up on first use and kept
+      Private::String* Interned(Private::String* p)
       {
-         PimplCollection& pimpls(PimplCollectionFromHash(SdbmHash(string)));
+         if(p->interned)
+            return p;
+
+         Private::String* copy(p->internedCopy.load(boost::memory_order_acquire));
+         if(copy)
+            return copy;
 
-         PimplCollection::iterator f = Find(pimpls, string);
-         if(f != pimpls.end())
-            return *f;
+         copy = Acquire(p->string);
+         Private::String* expected(NULL);
+         if(p->internedCopy.compare_exchange_strong(expected, copy, boost::memory_order_acq_rel, boost::memory_order_acquire))
+            return copy;
 
-         pimpls.push_back(new Private::String(string));
-         return pimpls.back();
+         // another thread was first
+         Release(copy);
+         return expected;
       }
 
-      void Remove(const std::string& string)
+      static void AddReference(Private::String* p)
       {
-         const size_t hash = SdbmHash(string);
-         PimplCollection& pimpls(PimplCollectionFromHash(hash));
-
-         pimpls.erase(Find(pimpls, string));
-         if(pimpls.empty())
-            RemovePimplCollection(hash);
+         p->referenceCount.fetch_add(1, boost::memory_order_relaxed);
+         p->CountReferenceOperation();
       }
 
-   private:
-      PimplMapCollection pimplMaps;
-      PimplMap& PimplMapFromHash(size_t hash)
+      void Release(Private::String* p)
       {
-         hash ^= 0x55555555;
-         if(pimplMaps.empty())
-            pimplMaps.resize(2<<10);
+         p->CountReferenceOperation();
 
-         return pimplMaps[hash%pimplMaps.size()];
+         if(!p->interned)
+         {
+            if(p->referenceCount.fetch_sub(1, boost::memory_order_release)!=1)
+               return;
+
+            boost::atomic_thread_fence(boost::memory_order_acquire);
+            if(Private::String* copy = p->internedCopy.load(boost::memory_order_relaxed))
+               Release(copy);
+            delete p;
+            return;
+         }
+
+         int count(p->referenceCount.load(boost::memory_order_relaxed));
+         while(count>1)
+         {
+            if(p->referenceCount.compare_exchange_weak(count, count-1, boost::memory_order_release, boost::memory_order_relaxed))
+               return;
+         }
+
+         Shard& shard(ShardFromHash(p->hash));
+         {
+            Lock lock(shard);
+            if(p->referenceCount.fetch_sub(1, boost::memory_order_acq_rel)!=1)
+               return;
+
+            shard.Erase(p);
+         }
+         delete p;
       }
 
-      #define HASH_MASK 0x00FFFFFF;
+   private:
+      static const size_t ShardBits = 6;
+      static const size_t ShardCount = 1<<ShardBits;
 
-      PimplCollection& PimplCollectionFromHash(size_t hash)
+      // Flat linear probing table, each slot keeps the full hash next to the pimpl so a probe
+      // only touches the pimpl's string on a hash match. Erase shifts the following entries
+      // back instead of leaving tombstones.
+      class Shard
       {
-         PimplMap& pimplMap(PimplMapFromHash(hash));
+      public:
+         Shard()
+            : count(0)
+         {}
 
-         hash &= HASH_MASK;
+         Private::String* Find(const std::string& string, hash_t hash) const
+         {
+            if(entries.empty())
+               return NULL;
+
+            const size_t mask(entries.size()-1);
+            for(size_t i=hash & mask; entries[i].p; i=(i+1) & mask)
+            {
+               const Entry& entry(entries[i]);
+               if(entry.hash==hash && entry.p->string==string)
+                  return entry.p;
+            }
+            return NULL;
+         }
+
+         void Insert(Private::String* p)
+         {
+            // keep the load factor under 3/4
+            if((count+1)*4>entries.size()*3)
+               Grow();
 
-         PimplCollectionPtr& pPimpls = pimplMap[hash];
-         if(!pPimpls)
-            pPimpls.reset(new PimplCollection);
+            Place(p);
+            count++;
+         }
 
-         return *pPimpls;
-      }
+         void Erase(Private::String* p)
+         {
+            const size_t mask(entries.size()-1);
+            size_t hole(p->hash & mask);
+            while(entries[hole].p!=p)
+               hole = (hole+1) & mask;
+
+            for(size_t i=(hole+1) & mask; entries[i].p; i=(i+1) & mask)
+            {
+               // move back entries whose home slot is not between the hole and their position
+               const size_t home(entries[i].hash & mask);
+               if(((i-home) & mask)>=((i-hole) & mask))
+               {
+                  entries[hole] = entries[i];
+                  hole = i;
+               }
+            }
+
+            entries[hole] = Entry();
+            count--;
+         }
+
+         boost::mutex mutex;
+
+      private:
+         struct Entry
+         {
+            Entry() : hash(0), p(NULL) {}
+
+            hash_t hash;
+            Private::String* p;
+         };
 
-      void RemovePimplCollection(size_t hash)
+         void Place(Private::String* p)
+         {
+            const size_t mask(entries.size()-1);
+            size_t i(p->hash & mask);
+            while(entries[i].p)
+               i = (i+1) & mask;
+
+            entries[i].hash = p->hash;
+            entries[i].p = p;
+         }
+
+         void Grow()
+         {
+            std::vector<Entry> old(entries.empty() ? 16 : entries.size()*2);
+            old.swap(entries);
+            for(size_t i=0; i<old.size(); i++)
+            {
+               if(old[i].p)
+                  Place(old[i].p);
+            }
+         }
+
+         std::vector<Entry> entries;
+         size_t count;
+      };
+
+      class Lock
       {
-         PimplMap& pimplMap(PimplMapFromHash(hash));
+      public:
+         Lock(Shard& shard)
+            : mutex(shard.mutex)
+         {
+            static Diagnostics::Detail::LockCounters& counters(Diagnostics::Detail::Counters("String"));
+            Diagnostics::Detail::Lock(mutex, counters);
+         }
+
+         ~Lock()
+         {
+            mutex.unlock();
+         }
 
-         hash &= HASH_MASK;
+      private:
+         boost::mutex& mutex;
+      };
 
-         pimplMap.erase(hash);
+      // the shard takes the top bits, the slots within a shard the low ones
+      Shard& ShardFromHash(hash_t hash)
+      {
+         return shards[hash>>(sizeof(hash_t)*8-ShardBits)];
       }
+
+      Shard shards[ShardCount];
    };
 }
 
 using namespace System;
 
-static boost::mutex& m(){
-   static boost::mutex mtx;
-   return mtx;
+static Private::String* PimplOf(Pimpl* p)
+{
+   assert(p && "moved-from String");
+   return static_cast<Private::String*>(p);
 }
-#define LOCK lock_t l(m());
-#define PIMPL_REF(r) static_cast<Private::String*>((r).p)
+
+#define PIMPL_REF(r) PimplOf((r).p)
 #define PIMPL Private::String* p(PIMPL_REF(*this));
 
-size_t Private::String::ReferenceCount() const
+const std::string& Private::StringInternalField(const System::String& string)
 {
-   LOCK
-   return referenceCount;
+   return PIMPL_REF(string)->string;
 }
 
-static StringFactory stringFactory;
+const size_t String::npos;
 
-static hash_t sdbm_hash(const unsigned char *key)
+// never destroyed, static Strings of other translation units may outlive it otherwise
+static StringFactory& stringFactory()
 {
-	hash_t h=0;
-	while(*key) h=*key++ + (h<<6) + (h<<16) - h;
-	return h;
+   static StringFactory* factory(new StringFactory);
+   return *factory;
 }
 
-static hash_t SdbmHash(const std::string& key)
+// words are read as little endian so hashes do not depend on the host byte order
+static boost::uint64_t LittleEndian(boost::uint64_t word)
 {
-   return sdbm_hash((const unsigned char *)key.c_str());
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__==__ORDER_BIG_ENDIAN__
+   return __builtin_bswap64(word);
+#else
+   return word;
+#endif
+}
+
+// Eight bytes per step, multiply-xorshift mixing and a murmur3 finalizer.
+// The result only depends on the content: it is the same across runs, processes and hosts
+// with the same size_t width, and may be persisted or used to partition keys.
+size_t Private::StringHash(const char* data, size_t size)
+{
+   typedef boost::uint64_t word_t;
+   const word_t k(0x9E3779B97F4A7C15ULL);
+
+   word_t h(size*k);
+
+   for(; size>=sizeof(word_t); data+=sizeof(word_t), size-=sizeof(word_t))
+   {
+      word_t word;
+      memcpy(&word, data, sizeof(word_t));
+      h = (h^LittleEndian(word))*k;
+      h ^= h>>32;
+   }
+
+   if(size)
+   {
+      word_t word(0);
+      memcpy(&word, data, size);
+      h = (h^LittleEndian(word))*k;
+      h ^= h>>32;
+   }
+
+   h ^= h>>33;
+   h *= 0xFF51AFD7ED558CCDULL;
+   h ^= h>>33;
+   h *= 0xC4CEB9FE1A85EC53ULL;
+   h ^= h>>33;
+
+   return (size_t)h;
+}
+
+static hash_t StringHash(const std::string& key)
+{
+   return Private::StringHash(key.data(), key.size());
 }
 
 String::String()
-   : p(NULL)
+   : p(stringFactory().Acquire(std::string()))
 {
-   LOCK
-   this->p = &stringFactory.FromString(std::string());
-   PIMPL
-   p->referenceCount++;
 }
 
 String::String(const std::string& string)
-   : p(NULL)
+   : p(stringFactory().Acquire(string))
+{
+}
+
+String::String(Pimpl* pimpl)
+   : p(pimpl)
+{
+}
+
+String String::Transient(const std::string& string)
+{
+   return String(StringFactory::AcquireTransient(string));
+}
+
+String String::Intern() const
 {
-   LOCK
-   this->p = &stringFactory.FromString(string);
    PIMPL
-   p->referenceCount++;
+   Private::String* interned(stringFactory().Interned(p));
+   StringFactory::AddReference(interned);
+   return String(interned);
+}
+
+bool String::IsInterned() const
+{
+   PIMPL
+   return p->interned;
 }
 
 String::~String()
 {
-   LOCK
+   if(!this->p)
+      return;
+
    PIMPL
-   p->referenceCount--;
-   if(!p->referenceCount)
-      stringFactory.Remove(p->string);
+   stringFactory().Release(p);
 }
 
 String::String(const String& src)
   : p(src.p)
 {
-   LOCK
    PIMPL
-   p->referenceCount++;
+   StringFactory::AddReference(p);
 }
 
-String& String::operator =(const String& src)
+String& String::operator =(String&& src) noexcept
 {
    if(this==&src)
       return *this;
 
-   LOCK
+   if(this->p)
    {
       PIMPL
-      p->referenceCount--;
-      if(!p->referenceCount)
-         delete p;
+      stringFactory().Release(p);
+   }
+
+   this->p = src.p;
+   src.p = NULL;
+   return *this;
+}
+
+String& String::operator =(const String& src)
+{
+   if(this->p==src.p)
+      return *this;
+
+   StringFactory::AddReference(PIMPL_REF(src));
+   if(this->p)
+   {
+      PIMPL
+      stringFactory().Release(p);
    }
 
    this->p = src.p;
-   PIMPL
-   p->referenceCount++;
 
    return *this;
 }
@@ -242,10 +498,11 @@ String::operator std::string() const
    return ToString();
 }
 
+// the content hash, kept on the pimpl: free for interned Strings, computed once for transients
 size_t String::HashCode() const
 {
    PIMPL
-   return (size_t)p;
+   return p->ContentHash();
 }
 
 std::string String::ToString() const
@@ -254,9 +511,29 @@ std::string String::ToString() const
    return p->string;
 }
 
+static bool StringEquals(const Private::String* p, const Private::String* other)
+{
+   if(p==other)
+      return true;
+   // one pimpl per interned content
+   if(p->interned && other->interned)
+      return false;
+
+   return p->string==other->string;
+}
+
 bool String::operator ==(const String comp) const
 {
-   return HashCode()==comp.HashCode();
+   PIMPL
+   return StringEquals(p, PIMPL_REF(comp));
+}
+
+// Dictionary keys go through here, the exact type test spares most of them the dynamic_cast
+bool String::Equals(const Object& other) const
+{
+   PIMPL
+   const String* string(typeid(other)==typeid(String) ? static_cast<const String*>(&other) : dynamic_cast<const String*>(&other));
+   return string && StringEquals(p, PIMPL_REF(*string));
 }
 
 const String String::Empty()
@@ -272,10 +549,107 @@ String String::Contat(String right) const
 
 String String::Contat(String left, String right)
 {
-   return String(PIMPL_REF(left)->string + PIMPL_REF(right)->string);
+   return Transient(PIMPL_REF(left)->string + PIMPL_REF(right)->string);
+}
+
+StringView String::Trim() const
+{
+   return StringView(*this).Trim();
+}
+
+StringView String::Trim(const String& chars) const
+{
+   return StringView(*this).Trim(chars);
+}
+
+StringView String::TrimLeft(const String& chars) const
+{
+   return StringView(*this).TrimLeft(chars);
+}
+
+StringView String::TrimRight(const String& chars) const
+{
+   return StringView(*this).TrimRight(chars);
+}
+
+StringTokens String::Split(const String& chars) const
+{
+   return StringView(*this).Split(chars);
+}
+
+size_t String::IndexOf(const String& str, size_t from) const
+{
+   return StringView(*this).IndexOf(str, from);
+}
+
+size_t String::IndexOf(char c, size_t from) const
+{
+   return StringView(*this).IndexOf(c, from);
+}
+
+size_t String::LastIndexOf(const String& str) const
+{
+   return StringView(*this).LastIndexOf(str);
+}
+
+size_t String::LastIndexOf(char c) const
+{
+   return StringView(*this).LastIndexOf(c);
+}
+
+size_t String::IndexOfAny(const String& chars, size_t from) const
+{
+   return StringView(*this).IndexOfAny(chars, from);
+}
+
+bool String::Contains(const String& str) const
+{
+   return StringView(*this).Contains(str);
+}
+
+bool String::StartsWith(const String& str) const
+{
+   return StringView(*this).StartsWith(str);
+}
+
+bool String::EndsWith(const String& str) const
+{
+   return StringView(*this).EndsWith(str);
+}
+
+String String::Replace(const String& oldStr, const String& newStr) const
+{
+   PIMPL
+   const std::string& source(p->string);
+   const std::string& from(PIMPL_REF(oldStr)->string);
+   const std::string& to(PIMPL_REF(newStr)->string);
+   if(from.empty())
+      throw InvalidArgumentException();
+
+   size_t found(source.find(from));
+   if(found==std::string::npos)
+      return *this;
+
+   std::string ret;
+   ret.reserve(source.size());
+   size_t start(0);
+   for(; found!=std::string::npos; found=source.find(from, start))
+   {
+      ret.append(source, start, found-start);
+      ret.append(to);
+      start = found+from.size();
+   }
+   ret.append(source, start, std::string::npos);
+
+   return Transient(ret);
+}
+
+String String::Remove(const String& str) const
+{
+   return Replace(str, Empty());
 }
 
-String operator +(String left, String right)
+String System::operator +(String left, String right)
 {
    return left.Contat(right);
 }
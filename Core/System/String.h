@@ -26,39 +26,83 @@
 #pragma once
 
 #include <string>
+#include <utility>
 #include <System/Object.h>
 
 namespace System
 {
+   class String;
+   class StringView;
+   class StringTokens;
+
+   namespace Private
+   {
+      const std::string& StringInternalField(const String& string);
+   }
+
+   // Immutable string. Strings built from std::string are interned: one shared pimpl per
+   // content, compared by pointer. Transient strings skip the intern pool until Intern()
+   // asks for their interned copy, and compare by content.
    class String : public Object
    {
    public:
+      static const size_t npos = static_cast<size_t>(-1);
+
       String();
       String(const std::string& string);
+      static String Transient(const std::string& string);
       virtual ~String();
       String(const String& src);
       String& operator =(const String& src);
 
+      // same contract as SharedHandle's moves
+      String(String&& src) noexcept : p(src.p) { src.p = NULL; }
+      String& operator =(String&& src) noexcept;
+
       bool operator ==(const String comp) const;
+      // content equality, the hash code alone may collide
+      bool Equals(const Object& other) const;
+
+      String Intern() const;
+      bool IsInterned() const;
 
       static const String Empty();
 
       operator std::string() const;
+      // content hash, stable across runs, see StringView::HashCode
       size_t HashCode() const;
       std::string ToString() const;
 
       String Contat(String right) const ;
       static String Contat(String left, String right);
 
-      // TODO
-      // String Trim(String chars) const;
-      // String TrimLeft(String chars) const;
-      // String TrimRight(String chars) const;
-      // StringCollection Split(String chars) const;
-      // String Replace(String oldStr, String newStr) const;
-      // String Remove(String str) const { return Replace(str, Emtpy()); }
+      // views on this string's storage, see System/StringView.h
+      StringView Trim() const;
+      StringView Trim(const String& chars) const;
+      StringView TrimLeft(const String& chars) const;
+      StringView TrimRight(const String& chars) const;
+      StringTokens Split(const String& chars) const;
+
+      // SIMD accelerated, positions are npos when absent
+      size_t IndexOf(const String& str, size_t from = 0) const;
+      size_t IndexOf(char c, size_t from = 0) const;
+      size_t LastIndexOf(const String& str) const;
+      size_t LastIndexOf(char c) const;
+      size_t IndexOfAny(const String& chars, size_t from = 0) const;
+      bool Contains(const String& str) const;
+      bool StartsWith(const String& str) const;
+      bool EndsWith(const String& str) const;
+
+      // a transient String, or this one when oldStr does not occur
+      String Replace(const String& oldStr, const String& newStr) const;
+      String Remove(const String& str) const;
 
    private:
+      friend const std::string& Private::StringInternalField(const String& string);
+
+      // adopts a reference already taken on pimpl
+      explicit String(Pimpl* pimpl);
+
       Pimpl* p;
    };
 
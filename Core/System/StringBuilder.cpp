@@ -0,0 +1,229 @@
+/**
+ * Copyright (c) 2011 Michel Foucault
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <System/StringBuilder.h>
+
+#include <cstdio>
+
+namespace System
+{
+   namespace Private
+   {
+      class StringBuilder : public System::SharedPimpl
+      {
+      public:
+         StringBuilder()
+         {}
+
+         // numbers are printed into a stack buffer, no stream or locale involved
+         template<class T>
+         void AppendFormat(const char* format, T value)
+         {
+            char digits[32];
+            const int size(snprintf(digits, sizeof(digits), format, value));
+            if(size>0)
+               buffer.append(digits, size);
+         }
+
+         std::string buffer;
+      };
+   }
+}
+
+using namespace System;
+
+#define PIMPL Private::StringBuilder* p(this->p.Get());
+
+StringBuilder::StringBuilder()
+  : p(new Private::StringBuilder)
+{}
+
+StringBuilder::StringBuilder(size_t capacity)
+  : p(new Private::StringBuilder)
+{
+   PIMPL
+   p->buffer.reserve(capacity);
+}
+
+size_t StringBuilder::HashCode() const
+{
+   return p.HashCode();
+}
+
+StringBuilder& StringBuilder::Append(const String& string)
+{
+   PIMPL
+   p->buffer.append(Private::StringInternalField(string));
+   return *this;
+}
+
+StringBuilder& StringBuilder::Append(const Object& object)
+{
+   PIMPL
+   p->buffer.append(object.ToString());
+   return *this;
+}
+
+StringBuilder& StringBuilder::Append(const std::string& string)
+{
+   PIMPL
+   p->buffer.append(string);
+   return *this;
+}
+
+StringBuilder& StringBuilder::Append(const char* string)
+{
+   PIMPL
+   p->buffer.append(string);
+   return *this;
+}
+
+StringBuilder& StringBuilder::Append(const char* data, size_t size)
+{
+   PIMPL
+   p->buffer.append(data, size);
+   return *this;
+}
+
+StringBuilder& StringBuilder::Append(char c)
+{
+   PIMPL
+   p->buffer.push_back(c);
+   return *this;
+}
+
+StringBuilder& StringBuilder::Append(int value)
+{
+   PIMPL
+   p->AppendFormat("%d", value);
+   return *this;
+}
+
+StringBuilder& StringBuilder::Append(unsigned int value)
+{
+   PIMPL
+   p->AppendFormat("%u", value);
+   return *this;
+}
+
+StringBuilder& StringBuilder::Append(long value)
+{
+   PIMPL
+   p->AppendFormat("%ld", value);
+   return *this;
+}
+
+StringBuilder& StringBuilder::Append(unsigned long value)
+{
+   PIMPL
+   p->AppendFormat("%lu", value);
+   return *this;
+}
+
+StringBuilder& StringBuilder::Append(long long value)
+{
+   PIMPL
+   p->AppendFormat("%lld", value);
+   return *this;
+}
+
+StringBuilder& StringBuilder::Append(unsigned long long value)
+{
+   PIMPL
+   p->AppendFormat("%llu", value);
+   return *this;
+}
+
+// same digits as the default std::ostream output
+StringBuilder& StringBuilder::Append(double value)
+{
+   PIMPL
+   p->AppendFormat("%g", value);
+   return *this;
+}
+
+StringBuilder& StringBuilder::AppendFormat(const String& format, const FormatArgument& arg1)
+{
+   PIMPL
+   const FormatArgument* args[] = { &arg1 };
+   Private::AppendFormat(p->buffer, format, args, 1);
+   return *this;
+}
+
+StringBuilder& StringBuilder::AppendFormat(const String& format, const FormatArgument& arg1, const FormatArgument& arg2)
+{
+   PIMPL
+   const FormatArgument* args[] = { &arg1, &arg2 };
+   Private::AppendFormat(p->buffer, format, args, 2);
+   return *this;
+}
+
+StringBuilder& StringBuilder::AppendFormat(const String& format, const FormatArgument& arg1, const FormatArgument& arg2, const FormatArgument& arg3)
+{
+   PIMPL
+   const FormatArgument* args[] = { &arg1, &arg2, &arg3 };
+   Private::AppendFormat(p->buffer, format, args, 3);
+   return *this;
+}
+
+StringBuilder& StringBuilder::AppendLine()
+{
+   return Append('\n');
+}
+
+StringBuilder& StringBuilder::AppendLine(const String& string)
+{
+   return Append(string).Append('\n');
+}
+
+size_t StringBuilder::Length() const
+{
+   PIMPL
+   return p->buffer.size();
+}
+
+size_t StringBuilder::Capacity() const
+{
+   PIMPL
+   return p->buffer.capacity();
+}
+
+void StringBuilder::Reserve(size_t capacity)
+{
+   PIMPL
+   p->buffer.reserve(capacity);
+}
+
+void StringBuilder::Clear()
+{
+   PIMPL
+   p->buffer.clear();
+}
+
+String StringBuilder::ToString() const
+{
+   PIMPL
+   return String::Transient(p->buffer);
+}
@@ -0,0 +1,80 @@
+/**
+ * Copyright (c) 2011 Michel Foucault
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <System/Object.h>
+#include <System/SharedPimpl.h>
+#include <System/String.h>
+#include <System/Format.h>
+
+namespace System
+{
+   namespace Private { class StringBuilder; }
+
+   // Mutable character buffer: appends never intern, the result is built once by ToString() as a
+   // transient String. Copies share the buffer, like the other handle types. Not an Object, whose
+   // ToString() returns a std::string.
+   class StringBuilder
+   {
+   public:
+      StringBuilder();
+      explicit StringBuilder(size_t capacity);
+
+      size_t HashCode() const;
+
+      StringBuilder& Append(const String& string);
+      StringBuilder& Append(const Object& object);
+      StringBuilder& Append(const std::string& string);
+      StringBuilder& Append(const char* string);
+      StringBuilder& Append(const char* data, size_t size);
+      StringBuilder& Append(char c);
+      StringBuilder& Append(int value);
+      StringBuilder& Append(unsigned int value);
+      StringBuilder& Append(long value);
+      StringBuilder& Append(unsigned long value);
+      StringBuilder& Append(long long value);
+      StringBuilder& Append(unsigned long long value);
+      StringBuilder& Append(double value);
+
+      // composite formatting as in Console::Write, see System/Format.h
+      StringBuilder& AppendFormat(const String& format, const FormatArgument& arg1);
+      StringBuilder& AppendFormat(const String& format, const FormatArgument& arg1, const FormatArgument& arg2);
+      StringBuilder& AppendFormat(const String& format, const FormatArgument& arg1, const FormatArgument& arg2, const FormatArgument& arg3);
+
+      StringBuilder& AppendLine();
+      StringBuilder& AppendLine(const String& string);
+
+      size_t Length() const;
+      size_t Capacity() const;
+      void Reserve(size_t capacity);
+      void Clear();
+
+      String ToString() const;
+
+   private:
+      SharedHandle<Private::StringBuilder> p;
+   };
+}
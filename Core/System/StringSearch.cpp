@@ -0,0 +1,334 @@
+/**
+ * Copyright (c) 2011 Michel Foucault
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+// Search kernels behind String and StringView. SSE2 and AVX2 variants are compiled per function
+// with target attributes and picked once at run time, other compilers and CPUs use the scalar ones.
+// Substring search tests the first and the last needle bytes of a whole block at once.
+
+#include <cstring>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+   #define SYSTEM_SIMD_SEARCH
+   #include <immintrin.h>
+#endif
+
+namespace
+{
+   const size_t npos = static_cast<size_t>(-1);
+
+   typedef size_t (*FindByteFunction)(const char* data, size_t size, char c);
+   typedef size_t (*FindFunction)(const char* data, size_t size, const char* needle, size_t needleSize);
+   typedef size_t (*FindAnyFunction)(const char* data, size_t size, const char* set, size_t setSize);
+
+   // libc's memchr is vectorized already and faster than a plain kernel, all targets use it
+   size_t IndexOfByteScalar(const char* data, size_t size, char c)
+   {
+      const void* found(memchr(data, c, size));
+      return found ? static_cast<const char*>(found)-data : npos;
+   }
+
+   size_t LastIndexOfByteScalar(const char* data, size_t size, char c)
+   {
+      while(size--)
+      {
+         if(data[size]==c)
+            return size;
+      }
+      return npos;
+   }
+
+   size_t IndexOfScalar(const char* data, size_t size, const char* needle, size_t needleSize)
+   {
+      for(size_t i=0; i+needleSize<=size; i++)
+      {
+         const size_t candidate(IndexOfByteScalar(data+i, size-needleSize+1-i, needle[0]));
+         if(candidate==npos)
+            return npos;
+
+         i += candidate;
+         if(!memcmp(data+i+1, needle+1, needleSize-1))
+            return i;
+      }
+      return npos;
+   }
+
+   size_t IndexOfAnyScalar(const char* data, size_t size, const char* set, size_t setSize)
+   {
+      bool table[256] = { false };
+      for(size_t i=0; i<setSize; i++)
+         table[static_cast<unsigned char>(set[i])] = true;
+
+      for(size_t i=0; i<size; i++)
+      {
+         if(table[static_cast<unsigned char>(data[i])])
+            return i;
+      }
+      return npos;
+   }
+
+#if defined(SYSTEM_SIMD_SEARCH)
+   // the highest set bit of a non-zero mask
+   inline unsigned HighBit(unsigned mask) { return 31-__builtin_clz(mask); }
+
+   __attribute__((target("sse2")))
+   size_t LastIndexOfByteSse2(const char* data, size_t size, char c)
+   {
+      const __m128i pattern(_mm_set1_epi8(c));
+      for(; size>=16; size-=16)
+      {
+         const __m128i block(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data+size-16)));
+         const unsigned mask(_mm_movemask_epi8(_mm_cmpeq_epi8(block, pattern)));
+         if(mask)
+            return size-16+HighBit(mask);
+      }
+      return LastIndexOfByteScalar(data, size, c);
+   }
+
+   __attribute__((target("avx2")))
+   size_t LastIndexOfByteAvx2(const char* data, size_t size, char c)
+   {
+      const __m256i pattern(_mm256_set1_epi8(c));
+      for(; size>=32; size-=32)
+      {
+         const __m256i block(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(data+size-32)));
+         const unsigned mask(_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, pattern)));
+         if(mask)
+            return size-32+HighBit(mask);
+      }
+      return LastIndexOfByteSse2(data, size, c);
+   }
+
+   // Candidates are positions where both the first and the last needle bytes match,
+   // only those are compared in full.
+   __attribute__((target("sse2")))
+   size_t IndexOfSse2(const char* data, size_t size, const char* needle, size_t needleSize)
+   {
+      const __m128i first(_mm_set1_epi8(needle[0]));
+      const __m128i last(_mm_set1_epi8(needle[needleSize-1]));
+
+      size_t i(0);
+      for(; i+needleSize-1+16<=size; i+=16)
+      {
+         const __m128i blockFirst(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data+i)));
+         const __m128i blockLast(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data+i+needleSize-1)));
+         unsigned mask(_mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(blockFirst, first), _mm_cmpeq_epi8(blockLast, last))));
+         for(; mask; mask&=mask-1)
+         {
+            const size_t candidate(i+__builtin_ctz(mask));
+            if(!memcmp(data+candidate+1, needle+1, needleSize-2))
+               return candidate;
+         }
+      }
+
+      const size_t tail(IndexOfScalar(data+i, size-i, needle, needleSize));
+      return tail==npos ? npos : i+tail;
+   }
+
+   __attribute__((target("avx2")))
+   size_t IndexOfAvx2(const char* data, size_t size, const char* needle, size_t needleSize)
+   {
+      const __m256i first(_mm256_set1_epi8(needle[0]));
+      const __m256i last(_mm256_set1_epi8(needle[needleSize-1]));
+
+      size_t i(0);
+
+      // two blocks per test while no candidate shows up
+      for(; i+needleSize-1+64<=size; i+=64)
+      {
+         const char* block(data+i);
+         const __m256i candidates0(_mm256_and_si256(
+            _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(block)), first),
+            _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(block+needleSize-1)), last)));
+         const __m256i candidates1(_mm256_and_si256(
+            _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(block+32)), first),
+            _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(block+32+needleSize-1)), last)));
+         if(_mm256_movemask_epi8(_mm256_or_si256(candidates0, candidates1)))
+            break;
+      }
+
+      for(; i+needleSize-1+32<=size; i+=32)
+      {
+         const __m256i blockFirst(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(data+i)));
+         const __m256i blockLast(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(data+i+needleSize-1)));
+         unsigned mask(_mm256_movemask_epi8(_mm256_and_si256(_mm256_cmpeq_epi8(blockFirst, first), _mm256_cmpeq_epi8(blockLast, last))));
+         for(; mask; mask&=mask-1)
+         {
+            const size_t candidate(i+__builtin_ctz(mask));
+            if(!memcmp(data+candidate+1, needle+1, needleSize-2))
+               return candidate;
+         }
+      }
+
+      const size_t tail(IndexOfSse2(data+i, size-i, needle, needleSize));
+      return tail==npos ? npos : i+tail;
+   }
+
+   // sets of up to 16 characters: one compare per character and block
+   __attribute__((target("sse2")))
+   size_t IndexOfAnySse2(const char* data, size_t size, const char* set, size_t setSize)
+   {
+      if(setSize>16)
+         return IndexOfAnyScalar(data, size, set, setSize);
+
+      __m128i patterns[16];
+      for(size_t s=0; s<setSize; s++)
+         patterns[s] = _mm_set1_epi8(set[s]);
+
+      size_t i(0);
+      for(; i+16<=size; i+=16)
+      {
+         const __m128i block(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data+i)));
+         __m128i matches(_mm_setzero_si128());
+         for(size_t s=0; s<setSize; s++)
+            matches = _mm_or_si128(matches, _mm_cmpeq_epi8(block, patterns[s]));
+
+         const unsigned mask(_mm_movemask_epi8(matches));
+         if(mask)
+            return i+__builtin_ctz(mask);
+      }
+
+      const size_t tail(IndexOfAnyScalar(data+i, size-i, set, setSize));
+      return tail==npos ? npos : i+tail;
+   }
+
+   __attribute__((target("avx2")))
+   size_t IndexOfAnyAvx2(const char* data, size_t size, const char* set, size_t setSize)
+   {
+      if(setSize>16)
+         return IndexOfAnyScalar(data, size, set, setSize);
+
+      __m256i patterns[16];
+      for(size_t s=0; s<setSize; s++)
+         patterns[s] = _mm256_set1_epi8(set[s]);
+
+      size_t i(0);
+      for(; i+32<=size; i+=32)
+      {
+         const __m256i block(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(data+i)));
+         __m256i matches(_mm256_setzero_si256());
+         for(size_t s=0; s<setSize; s++)
+            matches = _mm256_or_si256(matches, _mm256_cmpeq_epi8(block, patterns[s]));
+
+         const unsigned mask(_mm256_movemask_epi8(matches));
+         if(mask)
+            return i+__builtin_ctz(mask);
+      }
+
+      const size_t tail(IndexOfAnySse2(data+i, size-i, set, setSize));
+      return tail==npos ? npos : i+tail;
+   }
+#endif
+
+   struct Kernels
+   {
+      Kernels()
+         : lastIndexOfByte(&LastIndexOfByteScalar)
+         , indexOf(&IndexOfScalar)
+         , indexOfAny(&IndexOfAnyScalar)
+      {
+#if defined(SYSTEM_SIMD_SEARCH)
+         __builtin_cpu_init();
+         if(__builtin_cpu_supports("avx2"))
+         {
+            lastIndexOfByte = &LastIndexOfByteAvx2;
+            indexOf = &IndexOfAvx2;
+            indexOfAny = &IndexOfAnyAvx2;
+         }
+         else if(__builtin_cpu_supports("sse2"))
+         {
+            lastIndexOfByte = &LastIndexOfByteSse2;
+            indexOf = &IndexOfSse2;
+            indexOfAny = &IndexOfAnySse2;
+         }
+#endif
+      }
+
+      FindByteFunction lastIndexOfByte;
+      FindFunction indexOf;
+      FindAnyFunction indexOfAny;
+   };
+
+   const Kernels& kernels()
+   {
+      static const Kernels kernels;
+      return kernels;
+   }
+}
+
+namespace System
+{
+   namespace Private
+   {
+      size_t IndexOfByte(const char* data, size_t size, char c)
+      {
+         return IndexOfByteScalar(data, size, c);
+      }
+
+      size_t LastIndexOfByte(const char* data, size_t size, char c)
+      {
+         return kernels().lastIndexOfByte(data, size, c);
+      }
+
+      size_t IndexOf(const char* data, size_t size, const char* needle, size_t needleSize)
+      {
+         if(!needleSize)
+            return 0;
+         if(needleSize>size)
+            return npos;
+         if(needleSize==1)
+            return IndexOfByte(data, size, needle[0]);
+
+         return kernels().indexOf(data, size, needle, needleSize);
+      }
+
+      // scans backwards for the first needle byte, then compares the rest
+      size_t LastIndexOf(const char* data, size_t size, const char* needle, size_t needleSize)
+      {
+         if(!needleSize)
+            return size;
+         if(needleSize>size)
+            return npos;
+
+         for(size_t end(size-needleSize+1); end; )
+         {
+            const size_t candidate(LastIndexOfByte(data, end, needle[0]));
+            if(candidate==npos)
+               return npos;
+            if(!memcmp(data+candidate+1, needle+1, needleSize-1))
+               return candidate;
+            end = candidate;
+         }
+         return npos;
+      }
+
+      size_t IndexOfAny(const char* data, size_t size, const char* set, size_t setSize)
+      {
+         if(setSize==1)
+            return IndexOfByte(data, size, set[0]);
+
+         return kernels().indexOfAny(data, size, set, setSize);
+      }
+   }
+}
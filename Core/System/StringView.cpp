@@ -0,0 +1,241 @@
+/**
+ * Copyright (c) 2011 Michel Foucault
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <System/StringView.h>
+#include <System/Exception.h>
+
+#include <algorithm>
+#include <cstring>
+
+namespace System
+{
+   namespace Private
+   {
+      size_t StringHash(const char* data, size_t size);
+
+      // SIMD search kernels, see StringSearch.cpp
+      size_t IndexOfByte(const char* data, size_t size, char c);
+      size_t LastIndexOfByte(const char* data, size_t size, char c);
+      size_t IndexOf(const char* data, size_t size, const char* needle, size_t needleSize);
+      size_t LastIndexOf(const char* data, size_t size, const char* needle, size_t needleSize);
+      size_t IndexOfAny(const char* data, size_t size, const char* set, size_t setSize);
+
+      static bool Contains(const std::string& chars, char c)
+      {
+         return memchr(chars.data(), c, chars.size())!=NULL;
+      }
+
+      static const String& WhiteSpace()
+      {
+         static const String whiteSpace(std::string(" \t\r\n\f\v"));
+         return whiteSpace;
+      }
+   }
+}
+
+using namespace System;
+
+const size_t StringView::npos;
+
+StringView::StringView()
+   : string(String::Empty())
+   , data(Private::StringInternalField(string).data())
+   , size(0)
+{
+}
+
+StringView::StringView(const String& string)
+   : string(string)
+   , data(Private::StringInternalField(string).data())
+   , size(Private::StringInternalField(string).size())
+{
+}
+
+StringView::StringView(const String& string, size_t offset, size_t size)
+   : string(string)
+   , data(NULL)
+   , size(0)
+{
+   const std::string& storage(Private::StringInternalField(string));
+   if(offset>storage.size())
+      throw OutOfBoundException();
+
+   this->data = storage.data()+offset;
+   this->size = std::min(size, storage.size()-offset);
+}
+
+StringView StringView::Substring(size_t offset, size_t count) const
+{
+   if(offset>size)
+      throw OutOfBoundException();
+
+   StringView ret(*this);
+   ret.data += offset;
+   ret.size = std::min(count, size-offset);
+   return ret;
+}
+
+size_t StringView::IndexOf(const StringView& what, size_t from) const
+{
+   if(from>size)
+      return npos;
+
+   const size_t found(Private::IndexOf(data+from, size-from, what.data, what.size));
+   return found==npos ? npos : from+found;
+}
+
+size_t StringView::IndexOf(char c, size_t from) const
+{
+   if(from>size)
+      return npos;
+
+   const size_t found(Private::IndexOfByte(data+from, size-from, c));
+   return found==npos ? npos : from+found;
+}
+
+size_t StringView::LastIndexOf(const StringView& what) const
+{
+   return Private::LastIndexOf(data, size, what.data, what.size);
+}
+
+size_t StringView::LastIndexOf(char c) const
+{
+   return Private::LastIndexOfByte(data, size, c);
+}
+
+size_t StringView::IndexOfAny(const String& chars, size_t from) const
+{
+   if(from>size)
+      return npos;
+
+   const std::string& set(Private::StringInternalField(chars));
+   const size_t found(Private::IndexOfAny(data+from, size-from, set.data(), set.size()));
+   return found==npos ? npos : from+found;
+}
+
+bool StringView::StartsWith(const StringView& prefix) const
+{
+   return prefix.size<=size && !memcmp(data, prefix.data, prefix.size);
+}
+
+bool StringView::EndsWith(const StringView& suffix) const
+{
+   return suffix.size<=size && !memcmp(data+size-suffix.size, suffix.data, suffix.size);
+}
+
+StringView StringView::Trim() const
+{
+   return Trim(Private::WhiteSpace());
+}
+
+StringView StringView::Trim(const String& chars) const
+{
+   return TrimLeft(chars).TrimRight(chars);
+}
+
+StringView StringView::TrimLeft(const String& chars) const
+{
+   const std::string& set(Private::StringInternalField(chars));
+
+   StringView ret(*this);
+   while(ret.size && Private::Contains(set, *ret.data))
+   {
+      ret.data++;
+      ret.size--;
+   }
+   return ret;
+}
+
+StringView StringView::TrimRight(const String& chars) const
+{
+   const std::string& set(Private::StringInternalField(chars));
+
+   StringView ret(*this);
+   while(ret.size && Private::Contains(set, ret.data[ret.size-1]))
+      ret.size--;
+   return ret;
+}
+
+StringTokens StringView::Split(const String& chars) const
+{
+   return StringTokens(*this, chars);
+}
+
+bool StringView::operator ==(const StringView& view) const
+{
+   return size==view.size && (data==view.data || !memcmp(data, view.data, size));
+}
+
+size_t StringView::HashCode() const
+{
+   return Private::StringHash(data, size);
+}
+
+std::string StringView::ToString() const
+{
+   return std::string(data, size);
+}
+
+String StringView::ToTransientString() const
+{
+   return String::Transient(ToString());
+}
+
+StringTokens::StringTokens(const StringView& source, const String& separators)
+   : source(source)
+   , separators(separators)
+   , position(0)
+   , done(false)
+{
+}
+
+bool StringTokens::Next(StringView& token)
+{
+   if(done)
+      return false;
+
+   size_t end(source.IndexOfAny(separators, position));
+   if(end==StringView::npos)
+      end = source.Size();
+
+   token = source.Substring(position, end-position);
+   done = end==source.Size();
+   position = end+1;
+   return true;
+}
+
+Collections::StringCollection StringTokens::ToCollection()
+{
+   Collections::StringCollection ret;
+   StringView token;
+   while(Next(token))
+      ret.Add(token.ToTransientString());
+   return ret;
+}
+
+size_t StringTokens::HashCode() const
+{
+   return source.HashCode() ^ position;
+}
@@ -0,0 +1,102 @@
+/**
+ * Copyright (c) 2011 Michel Foucault
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <System/String.h>
+#include <System/Collections/StringCollection.h>
+
+namespace System
+{
+   // Read-only window on a String's storage. The view keeps its String alive, so slicing,
+   // trimming and splitting never copy characters nor touch the intern pool.
+   class StringView : public Object
+   {
+   public:
+      static const size_t npos = static_cast<size_t>(-1);
+
+      StringView();
+      StringView(const String& string);
+      StringView(const String& string, size_t offset, size_t size);
+
+      const char* Data() const { return data; }
+      size_t Size() const { return size; }
+      bool IsEmpty() const { return !size; }
+      char operator[](size_t index) const { return data[index]; }
+
+      StringView Substring(size_t offset, size_t count = npos) const;
+
+      // positions are relative to the view, npos when absent
+      size_t IndexOf(const StringView& what, size_t from = 0) const;
+      size_t IndexOf(char c, size_t from = 0) const;
+      size_t LastIndexOf(const StringView& what) const;
+      size_t LastIndexOf(char c) const;
+      size_t IndexOfAny(const String& chars, size_t from = 0) const;
+      bool Contains(const StringView& what) const { return IndexOf(what)!=npos; }
+      bool StartsWith(const StringView& prefix) const;
+      bool EndsWith(const StringView& suffix) const;
+
+      // chars defaults to white space
+      StringView Trim() const;
+      StringView Trim(const String& chars) const;
+      StringView TrimLeft(const String& chars) const;
+      StringView TrimRight(const String& chars) const;
+      StringTokens Split(const String& chars) const;
+
+      bool operator ==(const StringView& view) const;
+      bool operator !=(const StringView& view) const { return !(*this==view); }
+
+      // content hash, the same for every view of the same characters
+      size_t HashCode() const;
+      std::string ToString() const;
+      // copies the characters, interned only on demand, see String::Transient
+      String ToTransientString() const;
+
+   private:
+      String string;
+      const char* data;
+      size_t size;
+   };
+
+   // Lazy Split: each Next() yields the view up to the next separator character, empty
+   // entries included like String.Split in .NET. Nothing is allocated until ToCollection().
+   class StringTokens : public Object
+   {
+   public:
+      StringTokens(const StringView& source, const String& separators);
+
+      bool Next(StringView& token);
+      // the remaining tokens as transient Strings
+      Collections::StringCollection ToCollection();
+
+      size_t HashCode() const;
+
+   private:
+      StringView source;
+      String separators;
+      size_t position;
+      bool done;
+   };
+}
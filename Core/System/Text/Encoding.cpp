@@ -0,0 +1,771 @@
+/**
+ * Copyright (c) 2011 Michel Foucault
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+// UTF-8 validation follows Keiser and Lemire: the high and low nibbles of a byte's predecessor
+// and the high nibble of the byte itself index three tables whose AND is non-zero exactly when
+// the pair cannot occur in UTF-8, the bytes two and three positions back tell where a third or
+// fourth byte is due. The lookups need pshufb, so validation has SSSE3 and AVX2 kernels and plain
+// SSE2 CPUs use the scalar one. Transcoding decodes and encodes one code point at a time and moves
+// runs of ASCII with SSE2. Kernels are picked once at run time as in System/StringSearch.cpp.
+
+#include <System/Text/Encoding.h>
+#include <System/Text/Exception.h>
+#include <System/Threading/Locker.h>
+#include <System/Threading/Synchro.h>
+
+#include <cstring>
+#include <stdint.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+   #define SYSTEM_SIMD_ENCODING
+   #include <immintrin.h>
+#endif
+
+namespace
+{
+   using System::byte;
+
+   typedef bool (*ValidateFunction)(const byte* data, size_t size);
+   typedef size_t (*CountFunction)(const byte* data, size_t size);
+   // moves the ASCII prefix of the input and returns its length in code points
+   typedef size_t (*AsciiFunction)(const byte* in, size_t count, byte* out);
+
+   inline bool IsAscii8(const byte* data)
+   {
+      uint64_t word;
+      memcpy(&word, data, sizeof(word));
+      return !(word & 0x8080808080808080ULL);
+   }
+
+   // RFC 3629: shortest form only, no surrogates, nothing above U+10FFFF
+   bool ValidateScalar(const byte* data, size_t size)
+   {
+      size_t i(0);
+      while(i<size)
+      {
+         if(i+8<=size && IsAscii8(data+i))
+         {
+            i += 8;
+            continue;
+         }
+
+         const byte lead(data[i]);
+         if(lead<0x80)
+         {
+            i++;
+            continue;
+         }
+
+         size_t length(0);
+         byte low(0x80), high(0xBF);
+         if(lead>=0xC2 && lead<=0xDF)
+            length = 2;
+         else if(lead>=0xE0 && lead<=0xEF)
+         {
+            length = 3;
+            if(lead==0xE0)
+               low = 0xA0;
+            else if(lead==0xED)
+               high = 0x9F;
+         }
+         else if(lead>=0xF0 && lead<=0xF4)
+         {
+            length = 4;
+            if(lead==0xF0)
+               low = 0x90;
+            else if(lead==0xF4)
+               high = 0x8F;
+         }
+         else
+            return false;
+
+         if(size-i<length || data[i+1]<low || data[i+1]>high)
+            return false;
+         for(size_t k=2; k<length; k++)
+         {
+            if((data[i+k]&0xC0)!=0x80)
+               return false;
+         }
+         i += length;
+      }
+      return true;
+   }
+
+   // every byte but a continuation byte starts a code point
+   size_t CountScalar(const byte* data, size_t size)
+   {
+      size_t count(0);
+      for(size_t i=0; i<size; i++)
+         count += (data[i]&0xC0)!=0x80;
+      return count;
+   }
+
+   size_t WidenAscii16Scalar(const byte* in, size_t count, byte* out)
+   {
+      size_t i(0);
+      for(; i<count && in[i]<0x80; i++)
+      {
+         out[2*i] = in[i];
+         out[2*i+1] = 0;
+      }
+      return i;
+   }
+
+   size_t WidenAscii32Scalar(const byte* in, size_t count, byte* out)
+   {
+      size_t i(0);
+      for(; i<count && in[i]<0x80; i++)
+      {
+         out[4*i] = in[i];
+         out[4*i+1] = out[4*i+2] = out[4*i+3] = 0;
+      }
+      return i;
+   }
+
+   size_t NarrowAscii16Scalar(const byte* in, size_t count, byte* out)
+   {
+      size_t i(0);
+      for(; i<count && in[2*i]<0x80 && !in[2*i+1]; i++)
+         out[i] = in[2*i];
+      return i;
+   }
+
+   size_t NarrowAscii32Scalar(const byte* in, size_t count, byte* out)
+   {
+      size_t i(0);
+      for(; i<count && in[4*i]<0x80 && !(in[4*i+1]|in[4*i+2]|in[4*i+3]); i++)
+         out[i] = in[4*i];
+      return i;
+   }
+
+#if defined(SYSTEM_SIMD_ENCODING)
+   // error classes of a byte pair, see Keiser and Lemire, "Validating UTF-8 in less than one instruction per byte"
+   const byte TooShort = 1<<0;   // lead byte followed by a lead byte or ASCII
+   const byte TooLong = 1<<1;    // ASCII followed by a continuation byte
+   const byte Overlong3 = 1<<2;  // E0 80..9F
+   const byte TooLarge = 1<<3;   // F4 90..BF, F5..FF
+   const byte Surrogate = 1<<4;  // ED A0..BF
+   const byte Overlong2 = 1<<5;  // C0..C1
+   const byte TooLarge1000 = 1<<6; // F5..FF 80..8F
+   const byte Overlong4 = 1<<6;  // F0 80..8F
+   const byte TwoConts = 1<<7;   // continuation byte following a continuation byte, unless a third or fourth byte is due
+   const byte Carry = TooShort | TooLong | TwoConts;
+
+   // indexed by the high nibble of the previous byte
+   const byte byte1High[16] =
+   {
+      TooLong, TooLong, TooLong, TooLong, TooLong, TooLong, TooLong, TooLong,
+      TwoConts, TwoConts, TwoConts, TwoConts,
+      TooShort | Overlong2,
+      TooShort,
+      TooShort | Overlong3 | Surrogate,
+      TooShort | TooLarge | TooLarge1000 | Overlong4
+   };
+
+   // indexed by the low nibble of the previous byte
+   const byte byte1Low[16] =
+   {
+      Carry | Overlong3 | Overlong2 | Overlong4,
+      Carry | Overlong2,
+      Carry,
+      Carry,
+      Carry | TooLarge,
+      Carry | TooLarge | TooLarge1000,
+      Carry | TooLarge | TooLarge1000,
+      Carry | TooLarge | TooLarge1000,
+      Carry | TooLarge | TooLarge1000,
+      Carry | TooLarge | TooLarge1000,
+      Carry | TooLarge | TooLarge1000,
+      Carry | TooLarge | TooLarge1000,
+      Carry | TooLarge | TooLarge1000,
+      Carry | TooLarge | TooLarge1000 | Surrogate,
+      Carry | TooLarge | TooLarge1000,
+      Carry | TooLarge | TooLarge1000
+   };
+
+   // indexed by the high nibble of the current byte
+   const byte byte2High[16] =
+   {
+      TooShort, TooShort, TooShort, TooShort, TooShort, TooShort, TooShort, TooShort,
+      TooLong | Overlong2 | TwoConts | Overlong3 | TooLarge1000 | Overlong4,
+      TooLong | Overlong2 | TwoConts | Overlong3 | TooLarge,
+      TooLong | Overlong2 | TwoConts | Surrogate | TooLarge,
+      TooLong | Overlong2 | TwoConts | Surrogate | TooLarge,
+      TooShort, TooShort, TooShort, TooShort
+   };
+
+   // a block whose last bytes exceed these ends inside a sequence
+   const byte incompleteMax[32] =
+   {
+      0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+      0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xF0-1, 0xE0-1, 0xC0-1
+   };
+
+   __attribute__((target("ssse3")))
+   inline __m128i Lookup(const byte* table, __m128i nibbles)
+   {
+      return _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(table)), nibbles);
+   }
+
+   // the error bits of a block given the block before it
+   __attribute__((target("ssse3")))
+   inline __m128i CheckSsse3(__m128i input, __m128i previous)
+   {
+      const __m128i nibble(_mm_set1_epi8(0x0F));
+      const __m128i prev1(_mm_alignr_epi8(input, previous, 16-1));
+      const __m128i prev2(_mm_alignr_epi8(input, previous, 16-2));
+      const __m128i prev3(_mm_alignr_epi8(input, previous, 16-3));
+
+      const __m128i special(_mm_and_si128(_mm_and_si128(
+         Lookup(byte1High, _mm_and_si128(_mm_srli_epi16(prev1, 4), nibble)),
+         Lookup(byte1Low, _mm_and_si128(prev1, nibble))),
+         Lookup(byte2High, _mm_and_si128(_mm_srli_epi16(input, 4), nibble))));
+
+      // only 111_____ two back and 1111____ three back reach 0x80
+      const __m128i mustBe23(_mm_or_si128(
+         _mm_subs_epu8(prev2, _mm_set1_epi8(static_cast<char>(0xE0-0x80))),
+         _mm_subs_epu8(prev3, _mm_set1_epi8(static_cast<char>(0xF0-0x80)))));
+      return _mm_xor_si128(_mm_and_si128(mustBe23, _mm_set1_epi8(static_cast<char>(0x80))), special);
+   }
+
+   __attribute__((target("ssse3")))
+   bool ValidateSsse3(const byte* data, size_t size)
+   {
+      const __m128i max(_mm_loadu_si128(reinterpret_cast<const __m128i*>(incompleteMax+16)));
+      __m128i error(_mm_setzero_si128());
+      __m128i previous(_mm_setzero_si128());
+      __m128i incomplete(_mm_setzero_si128());
+
+      byte tail[16] = { 0 };
+      for(size_t i=0; i<size; i+=16)
+      {
+         const byte* block(data+i);
+         if(size-i<16)
+         {
+            // zero padding reads as ASCII, which also flags a sequence cut by the end
+            memcpy(tail, block, size-i);
+            block = tail;
+         }
+
+         const __m128i input(_mm_loadu_si128(reinterpret_cast<const __m128i*>(block)));
+         if(!_mm_movemask_epi8(input))
+            error = _mm_or_si128(error, incomplete);
+         else
+         {
+            error = _mm_or_si128(error, CheckSsse3(input, previous));
+            incomplete = _mm_subs_epu8(input, max);
+         }
+         previous = input;
+      }
+      error = _mm_or_si128(error, incomplete);
+      return _mm_movemask_epi8(_mm_cmpeq_epi8(error, _mm_setzero_si128()))==0xFFFF;
+   }
+
+   __attribute__((target("avx2")))
+   inline __m256i Lookup(const byte* table, __m256i nibbles)
+   {
+      return _mm256_shuffle_epi8(_mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(table))), nibbles);
+   }
+
+   __attribute__((target("avx2")))
+   inline __m256i CheckAvx2(__m256i input, __m256i previous)
+   {
+      const __m256i nibble(_mm256_set1_epi8(0x0F));
+      // the upper half of previous below the lower half of input, alignr works per 128 bit lane
+      const __m256i shifted(_mm256_permute2x128_si256(previous, input, 0x21));
+      const __m256i prev1(_mm256_alignr_epi8(input, shifted, 16-1));
+      const __m256i prev2(_mm256_alignr_epi8(input, shifted, 16-2));
+      const __m256i prev3(_mm256_alignr_epi8(input, shifted, 16-3));
+
+      const __m256i special(_mm256_and_si256(_mm256_and_si256(
+         Lookup(byte1High, _mm256_and_si256(_mm256_srli_epi16(prev1, 4), nibble)),
+         Lookup(byte1Low, _mm256_and_si256(prev1, nibble))),
+         Lookup(byte2High, _mm256_and_si256(_mm256_srli_epi16(input, 4), nibble))));
+
+      const __m256i mustBe23(_mm256_or_si256(
+         _mm256_subs_epu8(prev2, _mm256_set1_epi8(static_cast<char>(0xE0-0x80))),
+         _mm256_subs_epu8(prev3, _mm256_set1_epi8(static_cast<char>(0xF0-0x80)))));
+      return _mm256_xor_si256(_mm256_and_si256(mustBe23, _mm256_set1_epi8(static_cast<char>(0x80))), special);
+   }
+
+   __attribute__((target("avx2")))
+   bool ValidateAvx2(const byte* data, size_t size)
+   {
+      const __m256i max(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(incompleteMax)));
+      __m256i error(_mm256_setzero_si256());
+      __m256i previous(_mm256_setzero_si256());
+      __m256i incomplete(_mm256_setzero_si256());
+
+      byte tail[32] = { 0 };
+      for(size_t i=0; i<size; i+=32)
+      {
+         const byte* block(data+i);
+         if(size-i<32)
+         {
+            memcpy(tail, block, size-i);
+            block = tail;
+         }
+
+         const __m256i input(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(block)));
+         if(!_mm256_movemask_epi8(input))
+            error = _mm256_or_si256(error, incomplete);
+         else
+         {
+            error = _mm256_or_si256(error, CheckAvx2(input, previous));
+            incomplete = _mm256_subs_epu8(input, max);
+         }
+         previous = input;
+      }
+      error = _mm256_or_si256(error, incomplete);
+      return _mm256_testz_si256(error, error);
+   }
+
+   // continuation bytes are the signed bytes below -64
+   __attribute__((target("sse2")))
+   size_t CountSse2(const byte* data, size_t size)
+   {
+      const __m128i continuation(_mm_set1_epi8(-65));
+      size_t count(0), i(0);
+      for(; i+16<=size; i+=16)
+      {
+         const __m128i block(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data+i)));
+         count += __builtin_popcount(_mm_movemask_epi8(_mm_cmpgt_epi8(block, continuation)));
+      }
+      return count+CountScalar(data+i, size-i);
+   }
+
+   __attribute__((target("avx2,popcnt")))
+   size_t CountAvx2(const byte* data, size_t size)
+   {
+      const __m256i continuation(_mm256_set1_epi8(-65));
+      size_t count(0), i(0);
+      for(; i+32<=size; i+=32)
+      {
+         const __m256i block(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(data+i)));
+         count += __builtin_popcount(_mm256_movemask_epi8(_mm256_cmpgt_epi8(block, continuation)));
+      }
+      return count+CountSse2(data+i, size-i);
+   }
+
+   // The ASCII kernels store a whole block even when it holds fewer ASCII code points, the
+   // callers size their output for the worst case and overwrite the excess.
+   __attribute__((target("sse2")))
+   size_t WidenAscii16Sse2(const byte* in, size_t count, byte* out)
+   {
+      const __m128i zero(_mm_setzero_si128());
+      size_t i(0);
+      for(; i+16<=count; i+=16)
+      {
+         const __m128i block(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in+i)));
+         _mm_storeu_si128(reinterpret_cast<__m128i*>(out+2*i), _mm_unpacklo_epi8(block, zero));
+         _mm_storeu_si128(reinterpret_cast<__m128i*>(out+2*i+16), _mm_unpackhi_epi8(block, zero));
+         const unsigned mask(_mm_movemask_epi8(block));
+         if(mask)
+            return i+__builtin_ctz(mask);
+      }
+      return i+WidenAscii16Scalar(in+i, count-i, out+2*i);
+   }
+
+   __attribute__((target("sse2")))
+   size_t WidenAscii32Sse2(const byte* in, size_t count, byte* out)
+   {
+      const __m128i zero(_mm_setzero_si128());
+      size_t i(0);
+      for(; i+16<=count; i+=16)
+      {
+         const __m128i block(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in+i)));
+         const __m128i low(_mm_unpacklo_epi8(block, zero));
+         const __m128i high(_mm_unpackhi_epi8(block, zero));
+         _mm_storeu_si128(reinterpret_cast<__m128i*>(out+4*i), _mm_unpacklo_epi16(low, zero));
+         _mm_storeu_si128(reinterpret_cast<__m128i*>(out+4*i+16), _mm_unpackhi_epi16(low, zero));
+         _mm_storeu_si128(reinterpret_cast<__m128i*>(out+4*i+32), _mm_unpacklo_epi16(high, zero));
+         _mm_storeu_si128(reinterpret_cast<__m128i*>(out+4*i+48), _mm_unpackhi_epi16(high, zero));
+         const unsigned mask(_mm_movemask_epi8(block));
+         if(mask)
+            return i+__builtin_ctz(mask);
+      }
+      return i+WidenAscii32Scalar(in+i, count-i, out+4*i);
+   }
+
+   __attribute__((target("sse2")))
+   size_t NarrowAscii16Sse2(const byte* in, size_t count, byte* out)
+   {
+      const __m128i nonAscii(_mm_set1_epi16(static_cast<short>(0xFF80)));
+      size_t i(0);
+      for(; i+8<=count; i+=8)
+      {
+         const __m128i block(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in+2*i)));
+         _mm_storel_epi64(reinterpret_cast<__m128i*>(out+i), _mm_packus_epi16(block, block));
+         const unsigned mask(_mm_movemask_epi8(_mm_cmpeq_epi16(_mm_and_si128(block, nonAscii), _mm_setzero_si128())));
+         if(mask!=0xFFFF)
+            return i+__builtin_ctz(~mask)/2;
+      }
+      return i+NarrowAscii16Scalar(in+2*i, count-i, out+i);
+   }
+
+   __attribute__((target("sse2")))
+   size_t NarrowAscii32Sse2(const byte* in, size_t count, byte* out)
+   {
+      const __m128i nonAscii(_mm_set1_epi32(static_cast<int>(0xFFFFFF80)));
+      size_t i(0);
+      for(; i+4<=count; i+=4)
+      {
+         const __m128i block(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in+4*i)));
+         const unsigned mask(_mm_movemask_epi8(_mm_cmpeq_epi32(_mm_and_si128(block, nonAscii), _mm_setzero_si128())));
+         if(mask!=0xFFFF)
+            return i+NarrowAscii32Scalar(in+4*i, count-i, out+i);
+
+         const __m128i words(_mm_packs_epi32(block, block));
+         const int bytes(_mm_cvtsi128_si32(_mm_packus_epi16(words, words)));
+         memcpy(out+i, &bytes, 4);
+      }
+      return i+NarrowAscii32Scalar(in+4*i, count-i, out+i);
+   }
+#endif
+
+   struct Kernels
+   {
+      Kernels()
+         : validate(&ValidateScalar)
+         , count(&CountScalar)
+         , widenAscii16(&WidenAscii16Scalar)
+         , widenAscii32(&WidenAscii32Scalar)
+         , narrowAscii16(&NarrowAscii16Scalar)
+         , narrowAscii32(&NarrowAscii32Scalar)
+      {
+#if defined(SYSTEM_SIMD_ENCODING)
+         __builtin_cpu_init();
+         if(__builtin_cpu_supports("sse2"))
+         {
+            count = &CountSse2;
+            widenAscii16 = &WidenAscii16Sse2;
+            widenAscii32 = &WidenAscii32Sse2;
+            narrowAscii16 = &NarrowAscii16Sse2;
+            narrowAscii32 = &NarrowAscii32Sse2;
+         }
+         if(__builtin_cpu_supports("ssse3"))
+            validate = &ValidateSsse3;
+         if(__builtin_cpu_supports("avx2"))
+         {
+            validate = &ValidateAvx2;
+            count = &CountAvx2;
+         }
+#endif
+      }
+
+      ValidateFunction validate;
+      CountFunction count;
+      AsciiFunction widenAscii16;
+      AsciiFunction widenAscii32;
+      AsciiFunction narrowAscii16;
+      AsciiFunction narrowAscii32;
+   };
+
+   const Kernels& kernels()
+   {
+      static const Kernels kernels;
+      return kernels;
+   }
+
+   // one code point of input already validated as UTF-8
+   inline unsigned DecodeUtf8(const byte*& data)
+   {
+      const unsigned lead(*data++);
+      if(lead<0xE0)
+         return (lead&0x1F)<<6 | (*data++&0x3F);
+
+      unsigned codePoint(lead<0xF0 ? lead&0x0F : lead&0x07);
+      codePoint = codePoint<<6 | (*data++&0x3F);
+      codePoint = codePoint<<6 | (*data++&0x3F);
+      if(lead>=0xF0)
+         codePoint = codePoint<<6 | (*data++&0x3F);
+      return codePoint;
+   }
+
+   inline byte* EncodeUtf8(unsigned codePoint, byte* out)
+   {
+      if(codePoint<0x80)
+         *out++ = static_cast<byte>(codePoint);
+      else if(codePoint<0x800)
+      {
+         *out++ = static_cast<byte>(0xC0 | codePoint>>6);
+         *out++ = static_cast<byte>(0x80 | (codePoint&0x3F));
+      }
+      else if(codePoint<0x10000)
+      {
+         *out++ = static_cast<byte>(0xE0 | codePoint>>12);
+         *out++ = static_cast<byte>(0x80 | (codePoint>>6&0x3F));
+         *out++ = static_cast<byte>(0x80 | (codePoint&0x3F));
+      }
+      else
+      {
+         *out++ = static_cast<byte>(0xF0 | codePoint>>18);
+         *out++ = static_cast<byte>(0x80 | (codePoint>>12&0x3F));
+         *out++ = static_cast<byte>(0x80 | (codePoint>>6&0x3F));
+         *out++ = static_cast<byte>(0x80 | (codePoint&0x3F));
+      }
+      return out;
+   }
+
+   inline byte* WriteUnit16(unsigned unit, byte* out)
+   {
+      *out++ = static_cast<byte>(unit);
+      *out++ = static_cast<byte>(unit>>8);
+      return out;
+   }
+
+   inline byte* WriteUnit32(unsigned unit, byte* out)
+   {
+      return WriteUnit16(unit>>16, WriteUnit16(unit, out));
+   }
+
+   inline unsigned ReadUnit16(const byte* in)
+   {
+      return in[0] | in[1]<<8;
+   }
+
+   inline unsigned ReadUnit32(const byte* in)
+   {
+      return in[0] | in[1]<<8 | in[2]<<16 | static_cast<unsigned>(in[3])<<24;
+   }
+
+   // UTF-16 output needs 2 bytes per input byte at most
+   size_t Utf8ToUtf16(const byte* in, size_t size, byte* out)
+   {
+      const byte* end(in+size);
+      byte* const start(out);
+      while(in<end)
+      {
+         const size_t ascii(kernels().widenAscii16(in, end-in, out));
+         in += ascii;
+         out += 2*ascii;
+         if(in==end)
+            break;
+
+         const unsigned codePoint(DecodeUtf8(in));
+         if(codePoint<0x10000)
+            out = WriteUnit16(codePoint, out);
+         else
+         {
+            out = WriteUnit16(0xD800 | (codePoint-0x10000)>>10, out);
+            out = WriteUnit16(0xDC00 | (codePoint&0x3FF), out);
+         }
+      }
+      return out-start;
+   }
+
+   // UTF-32 output needs 4 bytes per input byte at most
+   size_t Utf8ToUtf32(const byte* in, size_t size, byte* out)
+   {
+      const byte* end(in+size);
+      byte* const start(out);
+      while(in<end)
+      {
+         const size_t ascii(kernels().widenAscii32(in, end-in, out));
+         in += ascii;
+         out += 4*ascii;
+         if(in==end)
+            break;
+
+         out = WriteUnit32(DecodeUtf8(in), out);
+      }
+      return out-start;
+   }
+
+   // UTF-8 output needs 3 bytes per unit at most, throws on unpaired surrogates
+   size_t Utf16ToUtf8(const byte* in, size_t units, byte* out)
+   {
+      byte* const start(out);
+      size_t i(0);
+      while(i<units)
+      {
+         const size_t ascii(kernels().narrowAscii16(in+2*i, units-i, out));
+         i += ascii;
+         out += ascii;
+         if(i==units)
+            break;
+
+         unsigned codePoint(ReadUnit16(in+2*i++));
+         if(codePoint>=0xD800 && codePoint<=0xDFFF)
+         {
+            if(codePoint>=0xDC00 || i==units)
+               throw System::Text::InvalidEncodingException();
+            const unsigned low(ReadUnit16(in+2*i++));
+            if(low<0xDC00 || low>0xDFFF)
+               throw System::Text::InvalidEncodingException();
+            codePoint = 0x10000 + ((codePoint-0xD800)<<10) + (low-0xDC00);
+         }
+         out = EncodeUtf8(codePoint, out);
+      }
+      return out-start;
+   }
+
+   // UTF-8 output needs 4 bytes per unit at most, throws on surrogates and values past U+10FFFF
+   size_t Utf32ToUtf8(const byte* in, size_t units, byte* out)
+   {
+      byte* const start(out);
+      size_t i(0);
+      while(i<units)
+      {
+         const size_t ascii(kernels().narrowAscii32(in+4*i, units-i, out));
+         i += ascii;
+         out += ascii;
+         if(i==units)
+            break;
+
+         const unsigned codePoint(ReadUnit32(in+4*i++));
+         if(codePoint>0x10FFFF || (codePoint>=0xD800 && codePoint<=0xDFFF))
+            throw System::Text::InvalidEncodingException();
+         out = EncodeUtf8(codePoint, out);
+      }
+      return out-start;
+   }
+}
+
+namespace System
+{
+   namespace Private
+   {
+      byte_array& BufferInternalField(const System::Buffer& buffer);
+      Threading::Synchro& BufferInternalLock(const System::Buffer& buffer);
+   }
+
+   namespace Text
+   {
+      namespace Private
+      {
+         typedef size_t (*TranscodeFunction)(const byte* in, size_t count, byte* out);
+
+         inline const byte* Data(const std::string& string)
+         {
+            return reinterpret_cast<const byte*>(string.data());
+         }
+
+         inline const byte* Data(const byte_array& bytes)
+         {
+            return bytes.empty() ? NULL : &bytes[0];
+         }
+
+         // validated UTF-8 to a new Buffer of at most ratio bytes per input byte
+         Buffer Encode(const String& string, TranscodeFunction transcode, size_t ratio)
+         {
+            const std::string& utf8(System::Private::StringInternalField(string));
+            if(!kernels().validate(Data(utf8), utf8.size()))
+               throw InvalidEncodingException();
+
+            Buffer buffer;
+            if(!utf8.empty())
+            {
+               byte_array& bytes(System::Private::BufferInternalField(buffer));
+               bytes.resize(ratio*utf8.size());
+               bytes.resize(transcode(Data(utf8), utf8.size(), &bytes[0]));
+            }
+            return buffer;
+         }
+
+         // UTF-16 or UTF-32 units to a transient String of at most ratio bytes per unit
+         String Decode(const Buffer& buffer, TranscodeFunction transcode, size_t unitSize, size_t ratio)
+         {
+            Threading::Locker lock(System::Private::BufferInternalLock(buffer));
+            const byte_array& bytes(System::Private::BufferInternalField(buffer));
+            if(bytes.size()%unitSize)
+               throw InvalidEncodingException();
+            if(bytes.empty())
+               return String::Transient(std::string());
+
+            const size_t units(bytes.size()/unitSize);
+            std::string utf8(ratio*units, '\0');
+            utf8.resize(transcode(&bytes[0], units, reinterpret_cast<byte*>(&utf8[0])));
+            return String::Transient(utf8);
+         }
+      }
+   }
+}
+
+using namespace System;
+using namespace System::Text;
+
+bool Encoding::IsValidUtf8(const String& string)
+{
+   const std::string& utf8(System::Private::StringInternalField(string));
+   return kernels().validate(Private::Data(utf8), utf8.size());
+}
+
+bool Encoding::IsValidUtf8(const Buffer& buffer)
+{
+   Threading::Locker lock(System::Private::BufferInternalLock(buffer));
+   const byte_array& bytes(System::Private::BufferInternalField(buffer));
+   return kernels().validate(Private::Data(bytes), bytes.size());
+}
+
+size_t Encoding::CountCodePoints(const String& string)
+{
+   const std::string& utf8(System::Private::StringInternalField(string));
+   return kernels().count(Private::Data(utf8), utf8.size());
+}
+
+size_t Encoding::CountCodePoints(const Buffer& buffer)
+{
+   Threading::Locker lock(System::Private::BufferInternalLock(buffer));
+   const byte_array& bytes(System::Private::BufferInternalField(buffer));
+   return kernels().count(Private::Data(bytes), bytes.size());
+}
+
+String Encoding::FromUtf8(const Buffer& buffer)
+{
+   Threading::Locker lock(System::Private::BufferInternalLock(buffer));
+   const byte_array& bytes(System::Private::BufferInternalField(buffer));
+   if(!kernels().validate(Private::Data(bytes), bytes.size()))
+      throw InvalidEncodingException();
+   return String::Transient(std::string(bytes.begin(), bytes.end()));
+}
+
+Buffer Encoding::ToUtf8(const String& string)
+{
+   const std::string& utf8(System::Private::StringInternalField(string));
+   if(!kernels().validate(Private::Data(utf8), utf8.size()))
+      throw InvalidEncodingException();
+   return Buffer(byte_array(utf8.begin(), utf8.end()));
+}
+
+String Encoding::FromUtf16(const Buffer& buffer)
+{
+   return Private::Decode(buffer, &Utf16ToUtf8, 2, 3);
+}
+
+Buffer Encoding::ToUtf16(const String& string)
+{
+   return Private::Encode(string, &Utf8ToUtf16, 2);
+}
+
+String Encoding::FromUtf32(const Buffer& buffer)
+{
+   return Private::Decode(buffer, &Utf32ToUtf8, 4, 4);
+}
+
+Buffer Encoding::ToUtf32(const String& string)
+{
+   return Private::Encode(string, &Utf8ToUtf32, 4);
+}
@@ -0,0 +1,62 @@
+/**
+ * Copyright (c) 2011 Michel Foucault
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <System/String.h>
+#include <System/Buffer.h>
+
+namespace System
+{
+   namespace Text
+   {
+      // Conversions between Strings, which hold UTF-8, and encoded Buffers. UTF-16 and UTF-32
+      // Buffers are little endian without a byte order mark. Decoding validates its input and
+      // throws InvalidEncodingException, decoded Strings are transient so that callers decide
+      // what gets interned.
+      class Encoding
+      {
+      public:
+         static bool IsValidUtf8(const String& string);
+         static bool IsValidUtf8(const Buffer& buffer);
+
+         // code points of valid UTF-8, invalid input gives an unspecified count
+         static size_t CountCodePoints(const String& string);
+         static size_t CountCodePoints(const Buffer& buffer);
+
+         static String FromUtf8(const Buffer& buffer);
+         static Buffer ToUtf8(const String& string);
+
+         static String FromUtf16(const Buffer& buffer);
+         static Buffer ToUtf16(const String& string);
+
+         static String FromUtf32(const Buffer& buffer);
+         static Buffer ToUtf32(const String& string);
+
+      private:
+         Encoding();
+      };
+   }
+}
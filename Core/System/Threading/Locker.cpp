@@ -24,6 +24,7 @@
  */
 
 #include <System/Threading/Locker.h>
+#include <System/Diagnostics/Instrumentation.h>
 
 #include <boost/thread/mutex.hpp>
 typedef boost::lock_guard<boost::mutex> lock_t;
@@ -43,19 +44,19 @@ namespace System
       {
          boost::mutex& MutexInternalField(const Threading::Mutex& mutex);
 
-         class Locker : public System::Pimpl
+         class Locker : public System::SharedPimpl
          {
          public:
             Locker()
-               : referenceCount(0)
             {}
 
-            size_t ReferenceCount() const;
-
             void Lock(System::Threading::Mutex& mutex)
             {
+               static Diagnostics::Detail::LockCounters& counters(Diagnostics::Detail::Counters("Threading::Locker"));
+
                boost::mutex& mtx(MutexInternalField(mutex));
-               locker.reset(new lock_t(mtx));
+               Diagnostics::Detail::Lock(mtx, counters);
+               locker.reset(new lock_t(mtx, boost::adopt_lock));
             }
 
             void Unlock()
@@ -65,7 +66,6 @@ namespace System
 
             bool IsLocked() const { return locker.get()!=NULL; }
 
-            int referenceCount;
             lock_ptr locker;
          };
       }
@@ -74,80 +74,22 @@ namespace System
 
 using namespace System::Threading;
 
-static boost::mutex& m(){
-   static boost::mutex mtx;
-   return mtx;
-}
-#define LOCK lock_t l(m());
-#define PIMPL Private::Locker* p(static_cast<Private::Locker*>(this->p));
-
-size_t Private::Locker::ReferenceCount() const
-{
-   LOCK
-   return referenceCount;
-}
+#define PIMPL Private::Locker* p(this->p.Get());
 
 Locker::Locker()
   : p(new Private::Locker)
-{
-   LOCK
-   PIMPL
-   p->referenceCount++;
-}
-
-Locker::~Locker()
-{
-   LOCK
-   PIMPL
-   p->referenceCount--;
-   if(!p->referenceCount)
-      delete p;
-}
-
-Locker::Locker(const Locker& src)
-  : p(src.p)
-{
-   LOCK
-   PIMPL
-   p->referenceCount++;
-}
-
-Locker& Locker::operator =(const Locker& src)
-{
-   if(this==&src)
-      return *this;
-
-   LOCK
-   {
-      PIMPL
-      p->referenceCount--;
-      if(!p->referenceCount)
-         delete p;
-   }
-
-   this->p = src.p;
-   PIMPL
-   p->referenceCount++;
-
-   return *this;
-}
+{}
 
 Locker::Locker(Mutex mutex)
   : p(new Private::Locker())
 {
-   {
-      LOCK
-      PIMPL
-      p->referenceCount++;
-   }
    PIMPL
    p->Lock(mutex);
 }
 
 size_t Locker::HashCode() const
 {
-   PIMPL
-   return (size_t)p;
+   return p.HashCode();
 }
 
 void Locker::Lock(Mutex mutex)
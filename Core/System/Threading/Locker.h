@@ -26,19 +26,19 @@
 #pragma once
 
 #include <System/Object.h>
+#include <System/SharedPimpl.h>
 #include <System/Threading/Mutex.h>
 
 namespace System
 {
    namespace Threading
    {
+      namespace Private { class Locker; }
+
       class Locker : public Object
       {
       public:
          Locker();
-         virtual ~Locker();
-         Locker(const Locker& src);
-         Locker& operator =(const Locker& src);
 
          size_t HashCode() const;
 
@@ -49,7 +49,7 @@ namespace System
          bool IsLocked() const;
 
       private:
-         Pimpl* p;
+         SharedHandle<Private::Locker> p;
       };
    }
 }
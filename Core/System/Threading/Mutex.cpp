@@ -26,7 +26,6 @@
 #include <System/Threading/Mutex.h>
 
 #include <boost/thread/mutex.hpp>
-typedef boost::lock_guard<boost::mutex> lock_t;
 
 namespace System
 {
@@ -34,16 +33,12 @@ namespace System
    {
       namespace Private
       {
-         class Mutex : public System::Pimpl
+         class Mutex : public System::SharedPimpl
          {
          public:
             Mutex()
-               : referenceCount(0)
             {}
 
-            size_t ReferenceCount() const;
-
-            int referenceCount;
             boost::mutex mutex;
          };
 
@@ -58,66 +53,13 @@ namespace System
 
 using namespace System::Threading;
 
-static boost::mutex& m(){
-   static boost::mutex mtx;
-   return mtx;
-}
-#define LOCK lock_t l(m());
-#define PIMPL Private::Mutex* p(static_cast<Private::Mutex*>(this->p));
-
-size_t Private::Mutex::ReferenceCount() const
-{
-   LOCK
-   return referenceCount;
-}
+#define PIMPL Private::Mutex* p(this->p.Get());
 
 Mutex::Mutex()
   : p(new Private::Mutex)
-{
-   LOCK
-   PIMPL
-   p->referenceCount++;
-}
-
-Mutex::~Mutex()
-{
-   LOCK
-   PIMPL
-   p->referenceCount--;
-   if(!p->referenceCount)
-      delete p;
-}
-
-Mutex::Mutex(const Mutex& src)
-  : p(src.p)
-{
-   LOCK
-   PIMPL
-   p->referenceCount++;
-}
-
-Mutex& Mutex::operator =(const Mutex& src)
-{
-   if(this==&src)
-      return *this;
-
-   LOCK
-   {
-      PIMPL
-      p->referenceCount--;
-      if(!p->referenceCount)
-         delete p;
-   }
-
-   this->p = src.p;
-   PIMPL
-   p->referenceCount++;
-
-   return *this;
-}
+{}
 
 size_t Mutex::HashCode() const
 {
-   PIMPL
-   return (size_t)p;
+   return p.HashCode();
 }
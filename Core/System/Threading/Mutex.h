@@ -25,23 +25,23 @@
 
 #pragma once
 #include <System/Object.h>
+#include <System/SharedPimpl.h>
 
 namespace System
 {
    namespace Threading
    {
+      namespace Private { class Mutex; }
+
       class Mutex : public Object
       {
       public:
          Mutex();
-         ~Mutex();
-         Mutex(const Mutex& src);
-         Mutex& operator =(const Mutex& src);
 
          size_t HashCode() const;
 
       private:
-         Pimpl* p;
+         SharedHandle<Private::Mutex> p;
       };
    }
 }
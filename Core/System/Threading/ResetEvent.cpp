@@ -28,27 +28,23 @@
 #include <boost/thread/mutex.hpp>
 #include <boost/thread/condition_variable.hpp>
 
-typedef boost::mutex::scoped_lock lock_t;
-
 namespace System
 {
    namespace Threading
    {
       namespace Private
       {
-         class ResetEvent : public System::Pimpl
+         class ResetEvent : public System::SharedPimpl
          {
          public:
             ResetEvent()
-               : referenceCount(0)
+               : data_ready(false)
             {}
 
-            size_t ReferenceCount() const;
-
             void Reset()
             {
                boost::lock_guard<boost::mutex> lock(mut);
-               data_ready=true;
+               data_ready=false;
             }
 
             void WaitOne()
@@ -60,6 +56,18 @@ namespace System
                }
             }
 
+            bool WaitOne(size_t msecs)
+            {
+               const boost::system_time timeout(boost::get_system_time()+boost::posix_time::milliseconds(msecs));
+               boost::unique_lock<boost::mutex> lock(mut);
+               while(!data_ready)
+               {
+                  if(!cond.timed_wait(lock, timeout))
+                     return data_ready;
+               }
+               return true;
+            }
+
             void NotifyOne()
             {
                {
@@ -69,7 +77,15 @@ namespace System
                cond.notify_one();
             }
 
-            int referenceCount;
+            void NotifyAll()
+            {
+               {
+                  boost::lock_guard<boost::mutex> lock(mut);
+                  data_ready=true;
+               }
+               cond.notify_all();
+            }
+
             boost::condition_variable cond;
             boost::mutex mut;
             bool data_ready;
@@ -80,84 +96,43 @@ namespace System
 
 using namespace System::Threading;
 
-static boost::mutex& m(){
-   static boost::mutex mtx;
-   return mtx;
-}
-#define LOCK lock_t l(m());
-#define PIMPL Private::ResetEvent* p(static_cast<Private::ResetEvent*>(this->p));
-
-size_t Private::ResetEvent::ReferenceCount() const
-{
-   LOCK
-   return referenceCount;
-}
+#define PIMPL Private::ResetEvent* p(this->p.Get());
 
 ResetEvent::ResetEvent()
   : p(new Private::ResetEvent)
-{
-   LOCK
-   PIMPL
-   p->referenceCount++;
-}
+{}
 
-ResetEvent::~ResetEvent()
-{
-   LOCK
-   PIMPL
-   p->referenceCount--;
-   if(!p->referenceCount)
-      delete p;
-}
-
-ResetEvent::ResetEvent(const ResetEvent& src)
-  : p(src.p)
+void ResetEvent::Reset()
 {
-   LOCK
    PIMPL
-   p->referenceCount++;
+   p->Reset();
 }
 
-ResetEvent& ResetEvent::operator =(const ResetEvent& src)
+void ResetEvent::WaitOne()
 {
-   if(this==&src)
-      return *this;
-
-   LOCK
-   {
-      PIMPL
-      p->referenceCount--;
-      if(!p->referenceCount)
-         delete p;
-   }
-
-   this->p = src.p;
    PIMPL
-   p->referenceCount++;
-
-   return *this;
+   p->WaitOne();
 }
 
-void ResetEvent::Reset()
+bool ResetEvent::WaitOne(size_t msecs)
 {
    PIMPL
-   p->Reset();
+   return p->WaitOne(msecs);
 }
 
-void ResetEvent::WaitOne()
+void ResetEvent::NotifyOne()
 {
    PIMPL
-   p->WaitOne();
+   p->NotifyOne();
 }
 
-void ResetEvent::NotifyOne()
+void ResetEvent::NotifyAll()
 {
    PIMPL
-   p->NotifyOne();
+   p->NotifyAll();
 }
 
 size_t ResetEvent::HashCode() const
 {
-   PIMPL
-   return (size_t)p;
+   return p.HashCode();
 }
@@ -25,27 +25,33 @@
 
 #pragma once
 #include <System/Object.h>
+#include <System/SharedPimpl.h>
+
+#include <cstddef>
 
 namespace System
 {
    namespace Threading
    {
+      namespace Private { class ResetEvent; }
+
+      // Manual reset event: once notified it stays signaled, releasing every wait, until Reset()
       class ResetEvent : public Object
       {
       public:
          ResetEvent();
-         virtual ~ResetEvent();
-         ResetEvent(const ResetEvent& src);
-         ResetEvent& operator =(const ResetEvent& src);
 
          size_t HashCode() const;
 
          void Reset();
          void WaitOne();
+         // false when the event is still not signaled after the timeout
+         bool WaitOne(std::size_t msecs);
          void NotifyOne();
+         void NotifyAll();
 
       private:
-         Pimpl* p;
+         SharedHandle<Private::ResetEvent> p;
       };
    }
 }
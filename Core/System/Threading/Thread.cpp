@@ -32,9 +32,6 @@
 typedef boost::thread thread_t;
 typedef boost::shared_ptr<thread_t> thread_ptr;
 
-#include <boost/thread/mutex.hpp>
-typedef boost::lock_guard<boost::mutex> lock_t;
-
 using namespace std;
 namespace System
 {
@@ -42,12 +39,11 @@ namespace System
    {
       namespace Private
       {
-         class Thread : public System::Pimpl
+         class Thread : public System::SharedPimpl
          {
          public:
             Thread()
-               : referenceCount(0)
-               , started(false)
+               : started(false)
                , autojoin(true)
             {}
 
@@ -57,12 +53,10 @@ namespace System
                   Join();
             }
 
-            size_t ReferenceCount() const;
-
             void Start(SyncRunner runner)
             {
-               static Mutex mut;
-               Locker lock(mut);
+               static Threading::Mutex mut;
+               Threading::Locker lock(mut);
 
                // manage if thread is working (re-use Thread instance)
                if(thread && autojoin)
@@ -84,7 +78,6 @@ namespace System
                thread->join();
             }
 
-            int referenceCount;
             bool started;
             bool autojoin;
             thread_ptr thread;
@@ -95,68 +88,15 @@ namespace System
 
 using namespace System::Threading;
 
-static boost::mutex& m(){
-   static boost::mutex mtx;
-   return mtx;
-}
-#define LOCK lock_t l(m());
-#define PIMPL Private::Thread* p(static_cast<Private::Thread*>(this->p));
-
-size_t Private::Thread::ReferenceCount() const
-{
-   LOCK
-   return referenceCount;
-}
+#define PIMPL Private::Thread* p(this->p.Get());
 
 Thread::Thread()
   : p(new Private::Thread)
-{
-   LOCK
-   PIMPL
-   p->referenceCount++;
-}
-
-Thread::~Thread()
-{
-   LOCK
-   PIMPL
-   p->referenceCount--;
-   if(!p->referenceCount)
-      delete p;
-}
-
-Thread::Thread(const Thread& src)
-  : p(src.p)
-{
-   LOCK
-   PIMPL
-   p->referenceCount++;
-}
-
-Thread& Thread::operator =(const Thread& src)
-{
-   if(this==&src)
-      return *this;
-
-   LOCK
-   {
-      PIMPL
-      p->referenceCount--;
-      if(!p->referenceCount)
-         delete p;
-   }
-
-   this->p = src.p;
-   PIMPL
-   p->referenceCount++;
-
-   return *this;
-}
+{}
 
 size_t Thread::HashCode() const
 {
-   PIMPL
-   return (size_t)p;
+   return p.HashCode();
 }
 
 void Thread::Sleep(size_t msecs)
@@ -170,10 +110,11 @@ void Thread::Start(SyncRunner runner)
    p->Start(runner);
 }
 
+// an event per start: SyncRunner resets it, a shared one could be reset between another start's
+// notification and its wait
 void Thread::Start(Runner runner)
 {
-   static ResetEvent sync;
-   Start(SyncRunner(sync, runner));
+   Start(SyncRunner(ResetEvent(), runner));
 }
 
 void Thread::Join()
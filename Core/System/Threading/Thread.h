@@ -26,19 +26,19 @@
 #pragma once
 
 #include <System/Object.h>
+#include <System/SharedPimpl.h>
 #include <System/Threading/SyncRunner.h>
 
 namespace System
 {
    namespace Threading
    {
+      namespace Private { class Thread; }
+
       class Thread : public Object
       {
       public:
          Thread();
-         virtual ~Thread();
-         Thread(const Thread& src);
-         Thread& operator =(const Thread& src);
 
          size_t HashCode() const;
 
@@ -78,7 +78,7 @@ namespace System
          void Join();
 
       private:
-         Pimpl* p;
+         SharedHandle<Private::Thread> p;
       };
    }
 }
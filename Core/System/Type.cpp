@@ -24,13 +24,15 @@
  */
 
 #include <System/Type.h>
-#include <System/Threading/Locker.h>
-#include <System/Threading/Mutex.h>
 
 #include <map>
 #include <string>
 #include <typeinfo>
 
+#include <boost/atomic.hpp>
+#include <boost/thread/mutex.hpp>
+typedef boost::lock_guard<boost::mutex> lock_t;
+
 using namespace System;
 
 #if defined(_MSC_VER)
@@ -50,21 +52,119 @@ using namespace System;
    }
 #endif
 
-Type& Type::FromObject(const Object& object)
+namespace System
 {
-   static Threading::Mutex mutex;
-   Threading::Locker lock(mutex);
-
-   typedef std::map<size_t, System::Type> TypeMap;
-   static TypeMap typeMap;
-
-   const String typeName(RealName(typeid(object).name()));
+   namespace Private
+   {
+      // Type descriptors keyed by type_info address: an insert-only open addressing
+      // table read without locking, demangling and interning happen once per type
+      class TypeRegistry
+      {
+      public:
+         TypeRegistry()
+         {
+            for(size_t i=0; i<Capacity; ++i)
+            {
+               keys[i].store(NULL, boost::memory_order_relaxed);
+               values[i] = NULL;
+            }
+         }
+
+         System::Type& Find(const std::type_info& info)
+         {
+            const std::type_info* key(&info);
+            size_t index(Slot(key));
+            for(size_t probe=0; probe<Capacity; ++probe)
+            {
+               const std::type_info* current(keys[index].load(boost::memory_order_acquire));
+               if(current==key)
+                  return *values[index];
+               if(!current)
+                  break;
+               index = (index+1) & (Capacity-1);
+            }
+
+            return Insert(info);
+         }
+
+      private:
+         static const size_t Capacity = 1024; // power of two
+
+         static size_t Slot(const std::type_info* key)
+         {
+            return (reinterpret_cast<size_t>(key)>>4) * 0x9E3779B1u & (Capacity-1);
+         }
+
+         System::Type& Insert(const std::type_info& info)
+         {
+            lock_t lock(mutex);
+
+            // another thread may have inserted it meanwhile, or the table may be full
+            const std::type_info* key(&info);
+            size_t index(Slot(key));
+            size_t probe(0);
+            for(; probe<Capacity; ++probe)
+            {
+               const std::type_info* current(keys[index].load(boost::memory_order_relaxed));
+               if(current==key)
+                  return *values[index];
+               if(!current)
+                  break;
+               index = (index+1) & (Capacity-1);
+            }
+
+            std::map<const std::type_info*, System::Type*>::iterator known(overflow.find(key));
+            if(known!=overflow.end())
+               return *known->second;
+
+            // type_info objects of one type may differ across shared objects, share the descriptor by name
+            const std::string typeName(RealName(info.name()));
+            std::map<std::string, System::Type*>::iterator it(names.find(typeName));
+            System::Type* type(it!=names.end() ? it->second : NULL);
+            if(!type)
+            {
+               type = new System::Type(String(typeName), names.size()+1);
+               names.insert(std::make_pair(typeName, type));
+            }
+
+            if(probe<Capacity)
+            {
+               values[index] = type;
+               keys[index].store(key, boost::memory_order_release);
+            }
+            else
+            {
+               // full table: later lookups of this type_info take the lock but demangle no more
+               overflow.insert(std::make_pair(key, type));
+            }
+            return *type;
+         }
+
+         boost::atomic<const std::type_info*> keys[Capacity];
+         System::Type* values[Capacity];
+
+         boost::mutex mutex;
+         std::map<std::string, System::Type*> names;
+         std::map<const std::type_info*, System::Type*> overflow;
+      };
+
+      // never destroyed, Type references outlive static destruction order
+      static TypeRegistry& Types()
+      {
+         static TypeRegistry* registry(new TypeRegistry);
+         return *registry;
+      }
+   }
+}
 
-   const size_t code(typeName.HashCode());
-   if(typeMap.find(code)==typeMap.end())
-      typeMap.insert(std::make_pair(code, Type(typeName)));
+Type& Type::FromObject(const Object& object)
+{
+   return Private::Types().Find(typeid(object));
+}
 
-   return typeMap[code];
+Type& Type::FromTypeInfo(const std::type_info& info)
+{
+   return Private::Types().Find(info);
 }
 
 Type& Object::Type() const
@@ -79,14 +179,17 @@ std::string Type::ToString() const
 
 std::string Object::ToString() const
 {
-   const System::Type type(Type::FromObject(*this));
+   return Type::FromObject(*this).ToString();
+}
 
-   return type.ToString();
+bool Object::Equals(const Object& other) const
+{
+   return typeid(*this)==typeid(other) && HashCode()==other.HashCode();
 }
 
 static bool TypeEquals(const Type& op1, const Type& op2)
 {
-   return op1.Name()==op2.Name();
+   return op1.Id()==op2.Id();
 }
 
 bool Type::operator==(const Type& type) const
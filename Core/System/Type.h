@@ -28,26 +28,45 @@
 #include <System/SimpleObject.h>
 #include <System/String.h>
 
+#include <typeinfo>
+
 namespace System
 {
+   namespace Private { class TypeRegistry; }
+
    class Type : public SimpleObject
    {
    public:
-      Type() {}
-      Type(String name) : name(name) {}
+      Type() : id(0) {}
 
       static Type& FromObject(const Object& object);
+      static Type& FromTypeInfo(const std::type_info& info);
+
+      // resolved once per T, without constructing one: abstract types are fine
       template<class T>
-      static Type& Get() { T t; return FromObject(t); }
+      static Type& Of()
+      {
+         static Type& type(FromTypeInfo(typeid(T)));
+         return type;
+      }
+
+      template<class T>
+      static Type& Get() { return Of<T>(); }
 
       bool operator==(const Type& type) const;
       bool operator!=(const Type& type) const;
 
       String Name() const { return name; }
+      // stable for the process lifetime, 0 for the empty Type
+      size_t Id() const { return id; }
 
       std::string ToString() const;
 
    private:
+      friend class Private::TypeRegistry;
+      Type(String name, size_t id) : name(name), id(id) {}
+
       String name;
+      size_t id;
    };
 }
@@ -0,0 +1,106 @@
+/**
+ * Copyright (c) 2011 Michel Foucault
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <System/WeakObjectRef.h>
+
+using namespace System;
+
+WeakObjectRef::WeakObjectRef()
+  : p(NULL)
+{
+}
+
+WeakObjectRef::WeakObjectRef(const ObjectRef& ref)
+  : p(ref.p)
+{
+   if(p)
+      p->AddWeakReference();
+}
+
+WeakObjectRef::~WeakObjectRef()
+{
+   Release(p);
+}
+
+WeakObjectRef::WeakObjectRef(const WeakObjectRef& src)
+  : p(src.p)
+{
+   if(p)
+      p->AddWeakReference();
+}
+
+WeakObjectRef& WeakObjectRef::operator =(const WeakObjectRef& src)
+{
+   if(src.p)
+      src.p->AddWeakReference();
+   Release(p);
+
+   this->p = src.p;
+
+   return *this;
+}
+
+WeakObjectRef& WeakObjectRef::operator =(WeakObjectRef&& src) noexcept
+{
+   if(this==&src)
+      return *this;
+
+   Release(p);
+   this->p = src.p;
+   src.p = NULL;
+
+   return *this;
+}
+
+ObjectRef WeakObjectRef::Lock() const
+{
+   ObjectRef ret;
+   if(p && p->TryAddReference())
+      ret.p = p;
+
+   return ret;
+}
+
+bool WeakObjectRef::Expired() const
+{
+   return !p || !p->ReferenceCount();
+}
+
+void WeakObjectRef::Reset()
+{
+   Release(p);
+   p = NULL;
+}
+
+size_t WeakObjectRef::HashCode() const
+{
+   return (size_t)p;
+}
+
+void WeakObjectRef::Release(Detail::ObjectBlock* block)
+{
+   if(block && block->RemoveWeakReference())
+      delete block;
+}
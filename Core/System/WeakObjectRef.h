@@ -0,0 +1,59 @@
+/**
+ * Copyright (c) 2011 Michel Foucault
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <System/ObjectRef.h>
+
+namespace System
+{
+   // Non-owning reference on an ObjectRef target: keeps the control block alive but not the
+   // object. Objects built by ObjectRef::Make share their block, their storage is only
+   // released with the last weak reference.
+   class WeakObjectRef : public Object
+   {
+   public:
+      WeakObjectRef();
+      WeakObjectRef(const ObjectRef& ref);
+      virtual ~WeakObjectRef();
+      WeakObjectRef(const WeakObjectRef& src);
+      WeakObjectRef& operator =(const WeakObjectRef& src);
+
+      WeakObjectRef(WeakObjectRef&& src) noexcept : p(src.p) { src.p = NULL; }
+      WeakObjectRef& operator =(WeakObjectRef&& src) noexcept;
+
+      // a strong reference on the target, or an empty ObjectRef once it is gone
+      ObjectRef Lock() const;
+      bool Expired() const;
+      void Reset();
+
+      size_t HashCode() const;
+
+   private:
+      static void Release(Detail::ObjectBlock* block);
+
+      Detail::ObjectBlock* p;
+   };
+}
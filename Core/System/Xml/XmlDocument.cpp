@@ -31,23 +31,34 @@
 
 #include <pugixml.hpp>
 
-#include <boost/thread/mutex.hpp>
-typedef boost::lock_guard<boost::mutex> lock_t;
-
 namespace System
 {
    namespace Xml
    {
       namespace Private
       {
-         class XmlDocument : public System::Pimpl
+         // appends straight into the std::string handed back by ToString
+         class StringWriter : public pugi::xml_writer
          {
          public:
-            XmlDocument()
-               : referenceCount(0)
+            StringWriter(std::string& text)
+               : text(text)
             {}
 
-            size_t ReferenceCount() const;
+            void write(const void* data, size_t size)
+            {
+               text.append(static_cast<const char*>(data), size);
+            }
+
+         private:
+            std::string& text;
+         };
+
+         class XmlDocument : public System::SharedPimpl
+         {
+         public:
+            XmlDocument()
+            {}
 
             void LoadFile(const std::string& xmlFile)
             {
@@ -74,10 +85,10 @@ namespace System
             {
                try
                {
-                  std::ostringstream oss;
-                  doc.save(oss);
-                  oss << "\0";
-                  return oss.str();
+                  std::string text;
+                  StringWriter writer(text);
+                  doc.save(writer);
+                  return text;
                }
                catch(std::exception&)
                {
@@ -85,8 +96,6 @@ namespace System
                }
             }
 
-            int referenceCount;
-
             pugi::xml_document doc;
          };
       }
@@ -96,68 +105,15 @@ namespace System
 using namespace System;
 using namespace System::Xml;
 
-static boost::mutex& m(){
-   static boost::mutex mtx;
-   return mtx;
-}
-#define LOCK lock_t l(m());
-#define PIMPL Private::XmlDocument* p(static_cast<Private::XmlDocument*>(this->p));
-
-size_t Private::XmlDocument::ReferenceCount() const
-{
-   LOCK
-   return referenceCount;
-}
+#define PIMPL Private::XmlDocument* p(this->p.Get());
 
 XmlDocument::XmlDocument()
   : p(new Private::XmlDocument)
-{
-   LOCK
-   PIMPL
-   p->referenceCount++;
-}
-
-XmlDocument::~XmlDocument()
-{
-   LOCK
-   PIMPL
-   p->referenceCount--;
-   if(!p->referenceCount)
-      delete p;
-}
-
-XmlDocument::XmlDocument(const XmlDocument& src)
-  : p(src.p)
-{
-   LOCK
-   PIMPL
-   p->referenceCount++;
-}
-
-XmlDocument& XmlDocument::operator =(const XmlDocument& src)
-{
-   if(this==&src)
-      return *this;
-
-   LOCK
-   {
-      PIMPL
-      p->referenceCount--;
-      if(!p->referenceCount)
-         delete p;
-   }
-
-   this->p = src.p;
-   PIMPL
-   p->referenceCount++;
-
-   return *this;
-}
+{}
 
 size_t XmlDocument::HashCode() const
 {
-   PIMPL
-   return (size_t)p;
+   return p.HashCode();
 }
 
 void XmlDocument::LoadFile(String fileName)
@@ -175,5 +131,5 @@ void XmlDocument::LoadXml(String xml)
 std::string XmlDocument::ToString() const
 {
    PIMPL
-   return String(p->ToString());
+   return p->ToString();
 }
@@ -26,19 +26,19 @@
 #pragma once
 
 #include <System/Object.h>
+#include <System/SharedPimpl.h>
 #include <System/String.h>
 
 namespace System
 {
    namespace Xml
    {
+      namespace Private { class XmlDocument; }
+
       class XmlDocument : public Object
       {
       public:
          XmlDocument();
-         virtual ~XmlDocument();
-         XmlDocument(const XmlDocument& src);
-         XmlDocument& operator =(const XmlDocument& src);
 
          size_t HashCode() const;
 
@@ -48,7 +48,7 @@ namespace System
          std::string ToString() const;
 
       private:
-         Pimpl* p;
+         SharedHandle<Private::XmlDocument> p;
       };
    }
 }
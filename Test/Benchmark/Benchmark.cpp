@@ -0,0 +1,78 @@
+/**
+ * Copyright (c) 2011 Michel Foucault
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "Benchmark.h"
+
+#include <boost/thread.hpp>
+#include <boost/thread/barrier.hpp>
+#include <boost/bind.hpp>
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+
+#include <iostream>
+#include <iomanip>
+
+namespace
+{
+   void Start(boost::barrier& barrier, Benchmark::ThreadBody body, size_t threadIndex)
+   {
+      barrier.wait();
+      body(threadIndex);
+   }
+}
+
+double Benchmark::Run(size_t threadCount, ThreadBody body)
+{
+   boost::barrier barrier(threadCount+1);
+   boost::thread_group threads;
+   for(size_t i=0; i<threadCount; i++)
+      threads.create_thread(boost::bind(&Start, boost::ref(barrier), body, i));
+
+   const boost::posix_time::ptime start(boost::posix_time::microsec_clock::universal_time());
+   barrier.wait();
+   threads.join_all();
+   const boost::posix_time::ptime end(boost::posix_time::microsec_clock::universal_time());
+
+   return (end-start).total_microseconds()/1e6;
+}
+
+size_t Benchmark::MaxThreads()
+{
+   const size_t hardware(boost::thread::hardware_concurrency());
+   return hardware ? 2*hardware : 2;
+}
+
+void Benchmark::Title(const std::string& title)
+{
+   std::cout << std::endl << "== " << title << std::endl;
+}
+
+void Benchmark::Report(const std::string& name, size_t threadCount, size_t operations, double seconds)
+{
+   const double mops(seconds>0 ? operations/seconds/1e6 : 0);
+   std::cout << std::left << std::setw(40) << name
+             << std::right << std::setw(4) << threadCount << " threads "
+             << std::setw(10) << std::fixed << std::setprecision(2) << mops << " Mops/s"
+             << std::setw(10) << std::setprecision(3) << seconds << " s" << std::endl;
+}
@@ -0,0 +1,60 @@
+/**
+ * Copyright (c) 2011 Michel Foucault
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <boost/function.hpp>
+
+#include <cstddef>
+#include <string>
+
+namespace Benchmark
+{
+   typedef boost::function<void (size_t)> ThreadBody;
+
+   // Run body(threadIndex) on threadCount threads released together, returns elapsed seconds
+   double Run(size_t threadCount, ThreadBody body);
+
+   // Thread counts to sweep: 1, 2, 4... up to twice the hardware concurrency
+   size_t MaxThreads();
+
+   void Title(const std::string& title);
+   void Report(const std::string& name, size_t threadCount, size_t operations, double seconds);
+}
+
+int ObjectRefBenchmark();
+int HandleBenchmark();
+int TypeBenchmark();
+int StringBenchmark();
+int StringInternBenchmark();
+int StringSearchBenchmark();
+int EncodingBenchmark();
+int FormatBenchmark();
+int ConsoleBenchmark();
+int DictionaryBenchmark();
+int ListBenchmark();
+int QueueBenchmark();
+int ConcurrentQueueBenchmark();
+int ConcurrentDictionaryBenchmark();
@@ -0,0 +1,167 @@
+/**
+ * Copyright (c) 2011 Michel Foucault
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "Benchmark.h"
+
+#include <System/String.h>
+#include <System/Collections/Generic/Dictionary.h>
+#include <System/Collections/Generic/ConcurrentDictionary.h>
+#include <System/Threading/Locker.h>
+#include <System/Threading/Mutex.h>
+
+#include <boost/bind.hpp>
+
+#include <sstream>
+#include <vector>
+
+using namespace System;
+
+namespace
+{
+   // A Dictionary behind one Locker, how a cache was shared so far
+   class LockedDictionary
+   {
+   public:
+      bool TryGetValue(const String& key, String& value)
+      {
+         Threading::Locker lock(mutex);
+         if(!dictionary.Contains(key))
+            return false;
+         value = dictionary[key];
+         return true;
+      }
+
+      void Set(const String& key, const String& value)
+      {
+         Threading::Locker lock(mutex);
+         if(dictionary.Contains(key))
+            dictionary[key] = value;
+         else
+            dictionary.Add(key, value);
+      }
+
+      void Remove(const String& key)
+      {
+         Threading::Locker lock(mutex);
+         if(dictionary.Contains(key))
+            dictionary.Remove(key);
+      }
+
+   private:
+      Threading::Mutex mutex;
+      Collections::Generic::Dictionary<String, String> dictionary;
+   };
+
+   class StripedDictionary
+   {
+   public:
+      bool TryGetValue(const String& key, String& value)
+      {
+         return dictionary.TryGetValue(key, value);
+      }
+
+      void Set(const String& key, const String& value)
+      {
+         dictionary.AddOrUpdate(key, value, Replace(value));
+      }
+
+      void Remove(const String& key)
+      {
+         dictionary.TryRemove(key);
+      }
+
+   private:
+      struct Replace
+      {
+         explicit Replace(const String& value) : value(value) {}
+         String operator()(const String&, const String&) const { return value; }
+         String value;
+      };
+
+      Collections::Generic::ConcurrentDictionary<String, String> dictionary;
+   };
+
+   const size_t keyCount = 1<<16;
+   const size_t operations = 1<<16; // per thread
+   const size_t maxThreads = 32;
+
+   volatile size_t sink;
+
+   // writes alternate between setting and removing, so the size stays around its start
+   template<class D>
+   void Mix(D& dictionary, const std::vector<String>& keys, size_t readPercent, size_t threadIndex)
+   {
+      size_t state(threadIndex*2654435761u+1);
+      size_t found(0);
+      String value;
+      for(size_t i=0; i<operations; i++)
+      {
+         state = state*6364136223846793005ULL+1442695040888963407ULL;
+         const String& key(keys[(state>>33)%keys.size()]);
+         if((state>>20)%100<readPercent)
+            found += dictionary.TryGetValue(key, value);
+         else if(i&1)
+            dictionary.Set(key, key);
+         else
+            dictionary.Remove(key);
+      }
+      sink = found;
+   }
+
+   template<class D>
+   void Measure(const std::string& name, const std::vector<String>& keys, size_t readPercent)
+   {
+      for(size_t threads=1; threads<=maxThreads; threads*=2)
+      {
+         D dictionary;
+         for(size_t i=0; i<keys.size(); i+=2)
+            dictionary.Set(keys[i], keys[i]);
+
+         const double seconds(Benchmark::Run(threads, boost::bind(&Mix<D>, boost::ref(dictionary), boost::cref(keys), readPercent, _1)));
+         Benchmark::Report(name, threads, threads*operations, seconds);
+      }
+   }
+}
+
+// 64K keys, half of them present at the start
+int ConcurrentDictionaryBenchmark()
+{
+   Benchmark::Title("ConcurrentDictionary<String, String>");
+
+   std::vector<String> keys;
+   keys.reserve(keyCount);
+   for(size_t i=0; i<keyCount; i++)
+   {
+      std::ostringstream key;
+      key << "key-" << i;
+      keys.push_back(String(key.str()));
+   }
+
+   Measure<LockedDictionary>("Dictionary + Locker, 90% reads", keys, 90);
+   Measure<StripedDictionary>("ConcurrentDictionary, 90% reads", keys, 90);
+   Measure<LockedDictionary>("Dictionary + Locker, 50% reads", keys, 50);
+   Measure<StripedDictionary>("ConcurrentDictionary, 50% reads", keys, 50);
+
+   return 0;
+}
@@ -0,0 +1,176 @@
+/**
+ * Copyright (c) 2011 Michel Foucault
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "Benchmark.h"
+
+#include <System/Collections/Generic/Queue.h>
+#include <System/Collections/Generic/ConcurrentQueue.h>
+#include <System/Threading/Locker.h>
+#include <System/Threading/Mutex.h>
+#include <System/Threading/Thread.h>
+
+#include <boost/bind.hpp>
+
+#include <algorithm>
+#include <vector>
+
+using namespace System;
+
+namespace
+{
+   // A Queue behind a Locker, how workers exchanged items so far
+   class LockedQueue
+   {
+   public:
+      void Enqueue(size_t item)
+      {
+         Threading::Locker lock(mutex);
+         queue.Enqueue(item);
+      }
+
+      bool TryDequeue(size_t& item)
+      {
+         Threading::Locker lock(mutex);
+         return queue.TryDequeue(item);
+      }
+
+   private:
+      Threading::Mutex mutex;
+      Collections::Generic::Queue<size_t> queue;
+   };
+
+   typedef Collections::Generic::ConcurrentQueue<size_t> ConcurrentQueue;
+
+   const size_t items = 1<<20;
+   const size_t batch = 64;
+
+   volatile size_t sink;
+
+   // even threads produce, odd threads consume, each pair moves an equal share of the items
+   template<class Q>
+   void Polling(Q& queue, size_t pairs, size_t threadIndex)
+   {
+      const size_t share(items/pairs);
+      if(threadIndex%2==0)
+      {
+         for(size_t i=0; i<share; i++)
+            queue.Enqueue(i);
+         return;
+      }
+
+      size_t sum(0), item;
+      for(size_t left=share; left; )
+      {
+         if(!queue.TryDequeue(item))
+         {
+            Threading::Thread::Yield();
+            continue;
+         }
+         sum += item;
+         left--;
+      }
+      sink = sum;
+   }
+
+   void Blocking(ConcurrentQueue& queue, size_t pairs, size_t threadIndex)
+   {
+      const size_t share(items/pairs);
+      if(threadIndex%2==0)
+      {
+         for(size_t i=0; i<share; i++)
+            queue.Enqueue(i);
+         return;
+      }
+
+      size_t sum(0);
+      for(size_t i=0; i<share; i++)
+         sum += queue.Dequeue();
+      sink = sum;
+   }
+
+   void Batched(ConcurrentQueue& queue, size_t pairs, size_t threadIndex)
+   {
+      const size_t share(items/pairs);
+      std::vector<size_t> buffer;
+      buffer.reserve(batch);
+      if(threadIndex%2==0)
+      {
+         for(size_t i=0; i<share; i+=batch)
+         {
+            buffer.clear();
+            for(size_t j=i; j<std::min(i+batch, share); j++)
+               buffer.push_back(j);
+            queue.EnqueueRange(buffer);
+         }
+         return;
+      }
+
+      size_t sum(0);
+      for(size_t left=share; left; )
+      {
+         buffer.clear();
+         left -= queue.DequeueRange(buffer, std::min(batch, left));
+         for(size_t i=0; i<buffer.size(); i++)
+            sum += buffer[i];
+      }
+      sink = sum;
+   }
+
+   template<class Q, class F>
+   void Measure(const std::string& name, F f, size_t capacity)
+   {
+      for(size_t threads=2; threads<=std::max<size_t>(2, Benchmark::MaxThreads()); threads*=2)
+      {
+         Q queue(capacity ? Q(capacity) : Q());
+         const double seconds(Benchmark::Run(threads, boost::bind(f, boost::ref(queue), threads/2, _1)));
+         Benchmark::Report(name, threads, items, seconds);
+      }
+   }
+
+   void MeasureLocked()
+   {
+      for(size_t threads=2; threads<=std::max<size_t>(2, Benchmark::MaxThreads()); threads*=2)
+      {
+         LockedQueue queue;
+         const double seconds(Benchmark::Run(threads, boost::bind(&Polling<LockedQueue>, boost::ref(queue), threads/2, _1)));
+         Benchmark::Report("Queue + Locker, polling", threads, items, seconds);
+      }
+   }
+}
+
+// operations are items moved from a producer to a consumer
+int ConcurrentQueueBenchmark()
+{
+   Benchmark::Title("ConcurrentQueue<size_t>, producer/consumer pairs");
+
+   MeasureLocked();
+   Measure<ConcurrentQueue>("bounded 1024, polling", &Polling<ConcurrentQueue>, 1024);
+   Measure<ConcurrentQueue>("bounded 1024, blocking", &Blocking, 1024);
+   Measure<ConcurrentQueue>("bounded 1024, batches of 64", &Batched, 1024);
+   Measure<ConcurrentQueue>("unbounded, polling", &Polling<ConcurrentQueue>, 0);
+   Measure<ConcurrentQueue>("unbounded, blocking", &Blocking, 0);
+   Measure<ConcurrentQueue>("unbounded, batches of 64", &Batched, 0);
+
+   return 0;
+}
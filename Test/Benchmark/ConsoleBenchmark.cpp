@@ -0,0 +1,80 @@
+/**
+ * Copyright (c) 2011 Michel Foucault
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "Benchmark.h"
+
+#include <System/Console.h>
+
+#include <boost/bind.hpp>
+#include <fstream>
+#include <iostream>
+
+using namespace System;
+
+namespace
+{
+   const size_t lines = 1<<15;
+
+   void WriteLines(const String& format, size_t threadIndex)
+   {
+      for(size_t i=0; i<lines; i++)
+         Console::WriteLine(format, threadIndex, i, i*0.01);
+      Console::Flush();
+   }
+
+   void Measure(const std::string& name, const String& format)
+   {
+      for(size_t threads=1; threads<=Benchmark::MaxThreads(); threads*=2)
+      {
+         // output goes to the null device one system call per write, the cost of an unbuffered pipe
+         std::ofstream null;
+         null.rdbuf()->pubsetbuf(NULL, 0);
+         null.open("/dev/null");
+         std::streambuf* const out(std::cout.rdbuf(null.rdbuf()));
+         const double seconds(Benchmark::Run(threads, boost::bind(&WriteLines, boost::cref(format), _1)));
+         std::cout.rdbuf(out);
+
+         Benchmark::Report(name, threads, threads*lines, seconds);
+      }
+   }
+}
+
+// operations are lines, each thread flushes before it stops the clock
+int ConsoleBenchmark()
+{
+   Benchmark::Title("Console::WriteLine");
+
+   const String format("worker-{0} processed request {1} in {2:F2}ms");
+   Measure("synchronous", format);
+
+   Console::EnableAsync(4096, Console::Block);
+   Measure("asynchronous, block", format);
+   Console::EnableAsync(4096, Console::Drop);
+   Measure("asynchronous, drop", format);
+   std::cout << "dropped " << Console::Dropped() << " lines" << std::endl;
+   Console::DisableAsync();
+
+   return 0;
+}
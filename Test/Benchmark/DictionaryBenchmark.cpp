@@ -0,0 +1,129 @@
+/**
+ * Copyright (c) 2011 Michel Foucault
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "Benchmark.h"
+
+#include <System/String.h>
+#include <System/Exception.h>
+#include <System/Collections/Generic/Dictionary.h>
+
+#include <boost/bind.hpp>
+
+#include <map>
+#include <sstream>
+#include <vector>
+
+using namespace System;
+
+namespace
+{
+   // The previous Dictionary, kept for comparison: a std::map on the key's hash code and a boxed
+   // key per lookup
+   class LegacyDictionary
+   {
+   public:
+      void Add(const String& k, const String& v)
+      {
+         const ObjectRef key(ObjectRef::Make<String>(k));
+         if(objectMap.find(key.HashCode())!=objectMap.end())
+            throw ObjectPresentException();
+         objectMap.insert(std::make_pair(key.HashCode(), std::make_pair(key, ObjectRef::Make<String>(v))));
+      }
+
+      bool Contains(const String& k) const
+      {
+         return objectMap.find(ObjectRef::Make<String>(k).HashCode())!=objectMap.end();
+      }
+
+   private:
+      std::map<size_t, std::pair<ObjectRef, ObjectRef> > objectMap;
+   };
+
+   volatile size_t sink;
+
+   std::vector<String> Keys(size_t count)
+   {
+      std::vector<String> keys;
+      keys.reserve(count);
+      for(size_t i=0; i<count; i++)
+      {
+         std::ostringstream key;
+         key << "key-" << i;
+         keys.push_back(String(key.str()));
+      }
+      return keys;
+   }
+
+   template<class D>
+   void Insert(D& dictionary, const std::vector<String>& keys, size_t)
+   {
+      for(size_t i=0; i<keys.size(); i++)
+         dictionary.Add(keys[i], keys[i]);
+   }
+
+   // every key once in an order unrelated to insertion, the step is coprime with the count
+   template<class D>
+   void Lookup(const D& dictionary, const std::vector<String>& keys, size_t)
+   {
+      const size_t step(keys.size()>7919 ? 7919 : 1);
+      size_t found(0);
+      for(size_t i=0, k=0; i<keys.size(); i++, k=(k+step)%keys.size())
+         found += dictionary.Contains(keys[k]);
+      sink = found;
+   }
+
+   template<class D>
+   void Measure(const std::string& name, const std::vector<String>& keys, size_t rounds)
+   {
+      double insert(0), lookup(0);
+      for(size_t round=0; round<rounds; round++)
+      {
+         D dictionary;
+         insert += Benchmark::Run(1, boost::bind(&Insert<D>, boost::ref(dictionary), boost::cref(keys), _1));
+         lookup += Benchmark::Run(1, boost::bind(&Lookup<D>, boost::cref(dictionary), boost::cref(keys), _1));
+      }
+      Benchmark::Report(name+" insert", 1, rounds*keys.size(), insert);
+      Benchmark::Report(name+" lookup", 1, rounds*keys.size(), lookup);
+   }
+}
+
+int DictionaryBenchmark()
+{
+   Benchmark::Title("Dictionary<String, String>");
+
+   const size_t sizes[] = { 1000, 1000000, 10000000 };
+   for(size_t i=0; i<sizeof(sizes)/sizeof(sizes[0]); i++)
+   {
+      const std::vector<String> keys(Keys(sizes[i]));
+      const size_t rounds(sizes[i]<100000 ? 100 : 1);
+
+      std::ostringstream size;
+      size << sizes[i] << " keys, ";
+      Measure<LegacyDictionary>(size.str()+"std::map", keys, rounds);
+      Measure<Collections::Generic::Dictionary<String, String> >(size.str()+"Robin Hood", keys, rounds);
+   }
+
+   return 0;
+}
@@ -0,0 +1,154 @@
+/**
+ * Copyright (c) 2011 Michel Foucault
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "Benchmark.h"
+
+#include <System/String.h>
+#include <System/Buffer.h>
+#include <System/Text/Encoding.h>
+
+#include <boost/bind.hpp>
+
+using namespace System;
+using namespace System::Text;
+
+namespace
+{
+   const size_t repeats = 64;
+
+   volatile size_t sink;
+
+   // about 1 MB of UTF-8 repeating a line of the given text
+   std::string Text(const std::string& line)
+   {
+      std::string text;
+      while(text.size()<(1<<20))
+         text += line;
+      return text;
+   }
+
+   // one code point at a time with a branch per byte, the usual hand written validator
+   bool NaiveValidate(const std::string& text)
+   {
+      const unsigned char* data(reinterpret_cast<const unsigned char*>(text.data()));
+      const size_t size(text.size());
+      for(size_t i=0; i<size; )
+      {
+         const unsigned lead(data[i]);
+         size_t length;
+         unsigned codePoint;
+         if(lead<0x80) { i++; continue; }
+         else if((lead&0xE0)==0xC0) { length = 2; codePoint = lead&0x1F; }
+         else if((lead&0xF0)==0xE0) { length = 3; codePoint = lead&0x0F; }
+         else if((lead&0xF8)==0xF0) { length = 4; codePoint = lead&0x07; }
+         else return false;
+
+         if(i+length>size)
+            return false;
+         for(size_t k=1; k<length; k++)
+         {
+            if((data[i+k]&0xC0)!=0x80)
+               return false;
+            codePoint = codePoint<<6 | (data[i+k]&0x3F);
+         }
+         const unsigned shortest[5] = { 0, 0, 0x80, 0x800, 0x10000 };
+         if(codePoint<shortest[length] || codePoint>0x10FFFF || (codePoint>=0xD800 && codePoint<=0xDFFF))
+            return false;
+         i += length;
+      }
+      return true;
+   }
+
+   void Naive(const std::string& text, size_t)
+   {
+      for(size_t i=0; i<repeats; i++)
+         sink = NaiveValidate(text);
+   }
+
+   void Validate(const String& text, size_t)
+   {
+      for(size_t i=0; i<repeats; i++)
+         sink = Encoding::IsValidUtf8(text);
+   }
+
+   void Count(const String& text, size_t)
+   {
+      for(size_t i=0; i<repeats; i++)
+         sink = Encoding::CountCodePoints(text);
+   }
+
+   void ToUtf16(const String& text, size_t)
+   {
+      for(size_t i=0; i<repeats; i++)
+         sink = Encoding::ToUtf16(text).Size();
+   }
+
+   void FromUtf16(const Buffer& buffer, size_t)
+   {
+      for(size_t i=0; i<repeats; i++)
+         sink = Encoding::FromUtf16(buffer).HashCode();
+   }
+
+   void ToUtf32(const String& text, size_t)
+   {
+      for(size_t i=0; i<repeats; i++)
+         sink = Encoding::ToUtf32(text).Size();
+   }
+
+   void FromUtf32(const Buffer& buffer, size_t)
+   {
+      for(size_t i=0; i<repeats; i++)
+         sink = Encoding::FromUtf32(buffer).HashCode();
+   }
+
+   void Run(const std::string& title, const std::string& line)
+   {
+      const std::string text(Text(line));
+      const String string(String::Transient(text));
+      const size_t bytes(text.size()*repeats);
+
+      Benchmark::Report(title+", naive validation", 1, bytes, Benchmark::Run(1, boost::bind(&Naive, boost::cref(text), _1)));
+      Benchmark::Report(title+", Encoding::IsValidUtf8", 1, bytes, Benchmark::Run(1, boost::bind(&Validate, boost::cref(string), _1)));
+      Benchmark::Report(title+", Encoding::CountCodePoints", 1, bytes, Benchmark::Run(1, boost::bind(&Count, boost::cref(string), _1)));
+
+      const Buffer utf16(Encoding::ToUtf16(string));
+      const Buffer utf32(Encoding::ToUtf32(string));
+      Benchmark::Report(title+", Encoding::ToUtf16", 1, bytes, Benchmark::Run(1, boost::bind(&ToUtf16, boost::cref(string), _1)));
+      Benchmark::Report(title+", Encoding::FromUtf16", 1, bytes, Benchmark::Run(1, boost::bind(&FromUtf16, boost::cref(utf16), _1)));
+      Benchmark::Report(title+", Encoding::ToUtf32", 1, bytes, Benchmark::Run(1, boost::bind(&ToUtf32, boost::cref(string), _1)));
+      Benchmark::Report(title+", Encoding::FromUtf32", 1, bytes, Benchmark::Run(1, boost::bind(&FromUtf32, boost::cref(utf32), _1)));
+   }
+}
+
+// operations are UTF-8 bytes, Mops/s reads as MB/s
+int EncodingBenchmark()
+{
+   Benchmark::Title("UTF-8 validation and transcoding, MB/s");
+
+   Run("ASCII", "2026-10-17 12:00:00 worker-1 INFO: processed request 4711 in 12ms\n");
+   Run("mixed", "Zürich, Ελληνικά, русский, 日本語のテキスト, 한국어 and emoji 😀🚀 in one line\n");
+
+   return 0;
+}
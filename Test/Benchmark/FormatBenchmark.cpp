@@ -0,0 +1,102 @@
+/**
+ * Copyright (c) 2011 Michel Foucault
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "Benchmark.h"
+
+#include <System/String.h>
+#include <System/StringBuilder.h>
+#include <System/Collections/StringCollection.h>
+
+#include <boost/bind.hpp>
+#include <iomanip>
+#include <sstream>
+
+using namespace System;
+
+namespace
+{
+   const size_t iterations = 1<<17;
+
+   volatile size_t sink;
+
+   void Stream(size_t)
+   {
+      for(size_t i=0; i<iterations; i++)
+      {
+         std::ostringstream line;
+         line << "worker-" << i%8 << " processed request " << i << " in " << std::fixed << std::setprecision(2) << i*0.01 << "ms";
+         sink = line.str().size();
+      }
+   }
+
+   std::string ToString(double value)
+   {
+      std::ostringstream text;
+      text << std::fixed << std::setprecision(2) << value;
+      return text.str();
+   }
+
+   // what Console::Write did before formats were compiled: one interned String per argument
+   void Collection(size_t)
+   {
+      for(size_t i=0; i<iterations; i++)
+      {
+         Collections::StringCollection args;
+         args.Add(String(ToString(i%8)));
+         args.Add(String(ToString(i)));
+         args.Add(String(ToString(i*0.01)));
+
+         StringBuilder builder;
+         builder.Append("worker-").Append(args[0]).Append(" processed request ").Append(args[1]).Append(" in ").Append(args[2]).Append("ms");
+         sink = builder.Length();
+      }
+   }
+
+   void Format(const String& format, size_t)
+   {
+      StringBuilder builder(128);
+      for(size_t i=0; i<iterations; i++)
+      {
+         builder.Clear();
+         builder.AppendFormat(format, i%8, i, i*0.01);
+         sink = builder.Length();
+      }
+   }
+}
+
+int FormatBenchmark()
+{
+   Benchmark::Title("Formatted log lines");
+
+   const String format("worker-{0} processed request {1} in {2:F2}ms");
+   for(size_t threads=1; threads<=Benchmark::MaxThreads(); threads*=2)
+   {
+      Benchmark::Report("std::ostringstream", threads, threads*iterations, Benchmark::Run(threads, &Stream));
+      Benchmark::Report("StringCollection of interned args", threads, threads*iterations, Benchmark::Run(threads, &Collection));
+      Benchmark::Report("StringBuilder::AppendFormat", threads, threads*iterations, Benchmark::Run(threads, boost::bind(&Format, boost::cref(format), _1)));
+   }
+
+   return 0;
+}
@@ -0,0 +1,79 @@
+/**
+ * Copyright (c) 2011 Michel Foucault
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "Benchmark.h"
+
+#include <System.h>
+#include <System/Buffer.h>
+#include <System/Collections.h>
+#include <System/Threading.h>
+
+#include <boost/bind.hpp>
+#include <vector>
+
+using namespace System;
+
+namespace
+{
+   const size_t iterations = 1<<20;
+
+   // every thread copies and drops its own handle, the types used to share one lock per type
+   template<class H>
+   void CopyHandle(const std::vector<H>& handles, size_t threadIndex)
+   {
+      const H& mine(handles[threadIndex]);
+      for(size_t i=0; i<iterations; i++)
+      {
+         H copy(mine);
+      }
+   }
+
+   template<class H>
+   void Sweep(const std::string& name)
+   {
+      for(size_t threads=1; threads<=Benchmark::MaxThreads(); threads*=2)
+      {
+         const std::vector<H> handles(threads);
+         const double seconds(Benchmark::Run(threads, boost::bind(&CopyHandle<H>, boost::cref(handles), _1)));
+         Benchmark::Report(name, threads, threads*iterations, seconds);
+      }
+   }
+}
+
+int HandleBenchmark()
+{
+   Benchmark::Title("Pimpl handle copy/destroy");
+
+   Sweep<Buffer>("Buffer");
+   Sweep<Guid>("Guid");
+   Sweep<Random>("Random");
+   Sweep<Collections::Generic::List<String> >("List<String>");
+   Sweep<Collections::Generic::Dictionary<String, String> >("Dictionary<String, String>");
+   Sweep<Collections::Generic::Set<String> >("Set<String>");
+   Sweep<Threading::Mutex>("Threading::Mutex");
+   Sweep<Threading::ResetEvent>("Threading::ResetEvent");
+
+   return 0;
+}
@@ -0,0 +1,120 @@
+/**
+ * Copyright (c) 2011 Michel Foucault
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "Benchmark.h"
+
+#include <System/Guid.h>
+#include <System/NameValue.h>
+#include <System/String.h>
+#include <System/Collections/Generic/List.h>
+
+#include <boost/bind.hpp>
+
+#include <sstream>
+#include <vector>
+
+using namespace System;
+
+namespace
+{
+   const size_t count = 1000000;
+
+   volatile size_t sink;
+
+   struct HashSum
+   {
+      size_t sum;
+      HashSum() : sum(0) {}
+      template<class T>
+      void operator()(T& t) { sum += t.HashCode(); }
+   };
+
+   template<class L, class T>
+   void Fill(L& list, const std::vector<T>& items, size_t)
+   {
+      for(size_t i=0; i<items.size(); i++)
+         list.Add(items[i]);
+   }
+
+   template<class L>
+   void Walk(const L& list, size_t)
+   {
+      size_t sum(0);
+      for(size_t i=0; i<list.Count(); i++)
+         sum += list.At(i).HashCode();
+      sink = sum;
+   }
+
+   template<class L>
+   void Visit(L& list, size_t)
+   {
+      HashSum hashSum;
+      list.ForEach(hashSum);
+      sink = hashSum.sum;
+   }
+
+   template<class L>
+   void Copy(const L& list, size_t)
+   {
+      sink = list.ToArray().size();
+   }
+
+   // the boxed and contiguous storages behind List<T>, the boxed one is what every List used before
+   template<class T, bool Unboxed>
+   void Measure(const std::string& name, const std::vector<T>& items)
+   {
+      typedef Collections::Generic::Detail::ListStorage<T, Unboxed> L;
+      const std::string storage(Unboxed ? ", contiguous" : ", boxed");
+
+      L list;
+      Benchmark::Report(name+storage+" Add", 1, items.size(), Benchmark::Run(1, boost::bind(&Fill<L, T>, boost::ref(list), boost::cref(items), _1)));
+      Benchmark::Report(name+storage+" At", 1, items.size(), Benchmark::Run(1, boost::bind(&Walk<L>, boost::cref(list), _1)));
+      Benchmark::Report(name+storage+" ForEach", 1, items.size(), Benchmark::Run(1, boost::bind(&Visit<L>, boost::ref(list), _1)));
+      Benchmark::Report(name+storage+" ToArray", 1, items.size(), Benchmark::Run(1, boost::bind(&Copy<L>, boost::cref(list), _1)));
+   }
+}
+
+int ListBenchmark()
+{
+   Benchmark::Title("List<T>, 1M elements");
+
+   std::vector<Guid> guids;
+   std::vector<NameValue> nameValues;
+   guids.reserve(count);
+   nameValues.reserve(count);
+   for(size_t i=0; i<count; i++)
+   {
+      std::ostringstream name;
+      name << "name-" << i;
+      guids.push_back(Guid::New());
+      nameValues.push_back(NameValue(String(name.str()), String("value")));
+   }
+
+   Measure<Guid, false>("Guid", guids);
+   Measure<Guid, true>("Guid", guids);
+   Measure<NameValue, false>("NameValue", nameValues);
+   Measure<NameValue, true>("NameValue", nameValues);
+
+   return 0;
+}
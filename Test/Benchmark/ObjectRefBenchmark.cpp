@@ -0,0 +1,86 @@
+/**
+ * Copyright (c) 2011 Michel Foucault
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "Benchmark.h"
+
+#include <System/ObjectRef.h>
+
+#include <boost/bind.hpp>
+#include <vector>
+
+using namespace System;
+
+namespace
+{
+   class Payload : public Object
+   {
+   public:
+      size_t HashCode() const { return 0; }
+   };
+
+   const size_t iterations = 1<<20;
+
+   // every thread copies and drops the same handle: worst case, one contended counter
+   void CopyShared(const ObjectRef& shared, size_t)
+   {
+      for(size_t i=0; i<iterations; i++)
+      {
+         ObjectRef copy(shared);
+      }
+   }
+
+   // every thread works on its own handle: should scale with core count
+   void CopyPrivate(const std::vector<ObjectRef>& refs, size_t threadIndex)
+   {
+      const ObjectRef& mine(refs[threadIndex]);
+      for(size_t i=0; i<iterations; i++)
+      {
+         ObjectRef copy(mine);
+      }
+   }
+}
+
+int ObjectRefBenchmark()
+{
+   Benchmark::Title("ObjectRef copy/destroy");
+
+   for(size_t threads=1; threads<=Benchmark::MaxThreads(); threads*=2)
+   {
+      ObjectRef shared(ObjectRef::Create<Payload>());
+      const double seconds(Benchmark::Run(threads, boost::bind(&CopyShared, boost::cref(shared), _1)));
+      Benchmark::Report("shared handle", threads, threads*iterations, seconds);
+   }
+
+   for(size_t threads=1; threads<=Benchmark::MaxThreads(); threads*=2)
+   {
+      std::vector<ObjectRef> refs;
+      for(size_t i=0; i<threads; i++)
+         refs.push_back(ObjectRef::Create<Payload>());
+      const double seconds(Benchmark::Run(threads, boost::bind(&CopyPrivate, boost::cref(refs), _1)));
+      Benchmark::Report("private handles", threads, threads*iterations, seconds);
+   }
+
+   return 0;
+}
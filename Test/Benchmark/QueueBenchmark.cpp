@@ -0,0 +1,150 @@
+/**
+ * Copyright (c) 2011 Michel Foucault
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "Benchmark.h"
+
+#include <System/String.h>
+#include <System/Collections/Generic/List.h>
+#include <System/Collections/Generic/Queue.h>
+
+#include <boost/bind.hpp>
+
+#include <sstream>
+#include <vector>
+
+using namespace System;
+
+namespace
+{
+   // The previous Queue, kept for comparison: Dequeue erases the front of a List
+   template<class T>
+   class LegacyQueue
+   {
+   public:
+      bool Empty() const { return list.Empty(); }
+
+      void Enqueue(T t)
+      {
+         list.Add(t);
+      }
+
+      T Dequeue()
+      {
+         T ret(list.At(0));
+         list.RemoveAt(0);
+
+         return ret;
+      }
+
+   private:
+      Collections::Generic::List<T> list;
+   };
+
+   const size_t count = 100000;
+
+   volatile size_t sink;
+
+   template<class Q>
+   void Fill(Q& queue, const std::vector<String>& items, size_t)
+   {
+      for(size_t i=0; i<items.size(); i++)
+         queue.Enqueue(items[i]);
+   }
+
+   template<class Q>
+   void Drain(Q& queue, size_t)
+   {
+      size_t sum(0);
+      while(!queue.Empty())
+         sum += queue.Dequeue().HashCode();
+      sink = sum;
+   }
+
+   // a queue a few elements deep, every Enqueue is followed by a Dequeue
+   template<class Q>
+   void Steady(const std::vector<String>& items, size_t)
+   {
+      Q queue;
+      for(size_t i=0; i<8; i++)
+         queue.Enqueue(items[i]);
+
+      size_t sum(0);
+      for(size_t i=0; i<items.size(); i++)
+      {
+         queue.Enqueue(items[i]);
+         sum += queue.Dequeue().HashCode();
+      }
+      sink = sum;
+   }
+
+   void FillRange(Collections::Generic::Queue<String>& queue, const std::vector<String>& items, size_t)
+   {
+      queue.EnqueueRange(items);
+   }
+
+   void DrainRange(Collections::Generic::Queue<String>& queue, size_t)
+   {
+      std::vector<String> items;
+      items.reserve(1024);
+      size_t sum(0);
+      while(queue.DequeueRange(items, 1024))
+      {
+         sum += items.size();
+         items.clear();
+      }
+      sink = sum;
+   }
+
+   template<class Q>
+   void Measure(const std::string& name, const std::vector<String>& items)
+   {
+      Q queue;
+      Benchmark::Report(name+" Enqueue", 1, items.size(), Benchmark::Run(1, boost::bind(&Fill<Q>, boost::ref(queue), boost::cref(items), _1)));
+      Benchmark::Report(name+" Dequeue", 1, items.size(), Benchmark::Run(1, boost::bind(&Drain<Q>, boost::ref(queue), _1)));
+      Benchmark::Report(name+" Enqueue+Dequeue", 1, items.size(), Benchmark::Run(1, boost::bind(&Steady<Q>, boost::cref(items), _1)));
+   }
+}
+
+int QueueBenchmark()
+{
+   Benchmark::Title("Queue<String>, 100K elements");
+
+   std::vector<String> items;
+   items.reserve(count);
+   for(size_t i=0; i<count; i++)
+   {
+      std::ostringstream item;
+      item << "item-" << i;
+      items.push_back(String(item.str()));
+   }
+
+   Measure<LegacyQueue<String> >("List", items);
+   Measure<Collections::Generic::Queue<String> >("Ring buffer", items);
+
+   Collections::Generic::Queue<String> queue;
+   Benchmark::Report("Ring buffer EnqueueRange", 1, items.size(), Benchmark::Run(1, boost::bind(&FillRange, boost::ref(queue), boost::cref(items), _1)));
+   Benchmark::Report("Ring buffer DequeueRange", 1, items.size(), Benchmark::Run(1, boost::bind(&DrainRange, boost::ref(queue), _1)));
+
+   return 0;
+}
@@ -0,0 +1,136 @@
+/**
+ * Copyright (c) 2011 Michel Foucault
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "Benchmark.h"
+
+#include <System/String.h>
+
+#include <boost/bind.hpp>
+#include <sstream>
+#include <vector>
+
+using namespace System;
+
+namespace
+{
+   const size_t iterations = 1<<18;
+   const size_t keyCount = 1024;
+
+   std::vector<std::string> Keys(const std::string& prefix)
+   {
+      std::vector<std::string> keys;
+      for(size_t i=0; i<keyCount; i++)
+      {
+         std::ostringstream key;
+         key << prefix << i;
+         keys.push_back(key.str());
+      }
+      return keys;
+   }
+
+   // intern and release in one go: every construction is a lookup, every destruction the last reference
+   void InternRelease(const std::vector<std::vector<std::string> >& keys, size_t threadIndex)
+   {
+      const std::vector<std::string>& mine(keys[threadIndex]);
+      for(size_t i=0; i<iterations; i++)
+      {
+         String s(mine[i%keyCount]);
+      }
+   }
+
+   void TransientRelease(const std::vector<std::vector<std::string> >& keys, size_t threadIndex)
+   {
+      const std::vector<std::string>& mine(keys[threadIndex]);
+      for(size_t i=0; i<iterations; i++)
+      {
+         String s(String::Transient(mine[i%keyCount]));
+      }
+   }
+
+   // strings stay interned elsewhere: lookups hit and releases never drop the last reference
+   void InternLive(const std::vector<std::string>& keys, size_t)
+   {
+      for(size_t i=0; i<iterations; i++)
+      {
+         String s(keys[i%keyCount]);
+      }
+   }
+
+   void CopyShared(const String& shared, size_t)
+   {
+      for(size_t i=0; i<iterations; i++)
+      {
+         String copy(shared);
+      }
+   }
+}
+
+int StringBenchmark()
+{
+   Benchmark::Title("String intern/release");
+
+   for(size_t threads=1; threads<=Benchmark::MaxThreads(); threads*=2)
+   {
+      std::vector<std::vector<std::string> > keys;
+      for(size_t i=0; i<threads; i++)
+      {
+         std::ostringstream prefix;
+         prefix << "thread-" << i << "-key-";
+         keys.push_back(Keys(prefix.str()));
+      }
+      const double seconds(Benchmark::Run(threads, boost::bind(&InternRelease, boost::cref(keys), _1)));
+      Benchmark::Report("intern/release, private keys", threads, threads*iterations, seconds);
+   }
+
+   for(size_t threads=1; threads<=Benchmark::MaxThreads(); threads*=2)
+   {
+      std::vector<std::vector<std::string> > keys;
+      for(size_t i=0; i<threads; i++)
+      {
+         std::ostringstream prefix;
+         prefix << "thread-" << i << "-key-";
+         keys.push_back(Keys(prefix.str()));
+      }
+      const double seconds(Benchmark::Run(threads, boost::bind(&TransientRelease, boost::cref(keys), _1)));
+      Benchmark::Report("transient, private keys", threads, threads*iterations, seconds);
+   }
+
+   for(size_t threads=1; threads<=Benchmark::MaxThreads(); threads*=2)
+   {
+      const std::vector<std::string> keys(Keys("shared-key-"));
+      const std::vector<String> live(keys.begin(), keys.end());
+      const double seconds(Benchmark::Run(threads, boost::bind(&InternLive, boost::cref(keys), _1)));
+      Benchmark::Report("intern, live shared keys", threads, threads*iterations, seconds);
+   }
+
+   for(size_t threads=1; threads<=Benchmark::MaxThreads(); threads*=2)
+   {
+      const String shared(std::string("shared"));
+      const double seconds(Benchmark::Run(threads, boost::bind(&CopyShared, boost::cref(shared), _1)));
+      Benchmark::Report("copy/destroy", threads, threads*iterations, seconds);
+   }
+
+   return 0;
+}
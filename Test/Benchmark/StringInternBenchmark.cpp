@@ -0,0 +1,245 @@
+/**
+ * Copyright (c) 2011 Michel Foucault
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "Benchmark.h"
+
+#include <System/String.h>
+
+#include <boost/atomic.hpp>
+#include <boost/bind.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include <map>
+#include <sstream>
+#include <vector>
+
+using namespace System;
+
+namespace
+{
+   // The previous intern pool, kept for comparison: sdbm byte hash, sharded std::multimap buckets
+   class LegacyPool
+   {
+   public:
+      struct Node
+      {
+         Node(const std::string& string, size_t hash) : referenceCount(0), string(string), hash(hash) {}
+
+         boost::atomic<int> referenceCount;
+         const std::string string;
+         const size_t hash;
+      };
+
+      Node* Acquire(const std::string& string)
+      {
+         const size_t hash(Hash(string));
+         Shard& shard(shards[(hash ^ (hash>>16)) & (ShardCount-1)]);
+         boost::lock_guard<boost::mutex> lock(shard.mutex);
+
+         Node* node(NULL);
+         std::pair<Map::iterator, Map::iterator> range(shard.nodes.equal_range(hash));
+         for(Map::iterator it=range.first; it!=range.second && !node; ++it)
+         {
+            if(it->second->string==string)
+               node = it->second;
+         }
+
+         if(!node)
+         {
+            node = new Node(string, hash);
+            shard.nodes.insert(std::make_pair(hash, node));
+         }
+
+         node->referenceCount.fetch_add(1, boost::memory_order_relaxed);
+         return node;
+      }
+
+      void Release(Node* node)
+      {
+         int count(node->referenceCount.load(boost::memory_order_relaxed));
+         while(count>1)
+         {
+            if(node->referenceCount.compare_exchange_weak(count, count-1, boost::memory_order_release, boost::memory_order_relaxed))
+               return;
+         }
+
+         Shard& shard(shards[(node->hash ^ (node->hash>>16)) & (ShardCount-1)]);
+         {
+            boost::lock_guard<boost::mutex> lock(shard.mutex);
+            if(node->referenceCount.fetch_sub(1, boost::memory_order_acq_rel)!=1)
+               return;
+
+            std::pair<Map::iterator, Map::iterator> range(shard.nodes.equal_range(node->hash));
+            for(Map::iterator it=range.first; it!=range.second; ++it)
+            {
+               if(it->second==node)
+               {
+                  shard.nodes.erase(it);
+                  break;
+               }
+            }
+         }
+         delete node;
+      }
+
+   private:
+      static const size_t ShardCount = 64;
+      typedef std::multimap<size_t, Node*> Map;
+
+      struct Shard
+      {
+         boost::mutex mutex;
+         Map nodes;
+      };
+
+      static size_t Hash(const std::string& key)
+      {
+         size_t h(0);
+         for(const unsigned char* c=(const unsigned char*)key.c_str(); *c; c++)
+            h = *c + (h<<6) + (h<<16) - h;
+         return h;
+      }
+
+      Shard shards[ShardCount];
+   };
+
+   // identifier-like keys: camel case words and a numeric suffix, 6 to 30 characters
+   std::vector<std::string> Identifiers(size_t count)
+   {
+      static const char* words[] = { "Get", "Set", "Value", "Name", "Item", "Count", "Index", "Node", "Buffer", "Stream", "Async", "Handler" };
+      const size_t wordCount(sizeof(words)/sizeof(words[0]));
+
+      std::vector<std::string> keys;
+      for(size_t i=0; i<count; i++)
+      {
+         std::ostringstream key;
+         key << words[i%wordCount] << words[(i/wordCount)%wordCount] << words[(i*7)%wordCount] << i;
+         keys.push_back(key.str());
+      }
+      return keys;
+   }
+
+   // path-like keys sharing long prefixes, 40 to 90 characters
+   std::vector<std::string> Paths(size_t count)
+   {
+      std::vector<std::string> keys;
+      for(size_t i=0; i<count; i++)
+      {
+         std::ostringstream key;
+         key << "/usr/share/application/modules/component" << i%97 << "/resources/locale" << i%13 << "/document" << i << ".xml";
+         keys.push_back(key.str());
+      }
+      return keys;
+   }
+
+   // skewed reuse: low indices are drawn far more often, like hot names in a workload
+   std::vector<size_t> Skewed(size_t count, size_t draws)
+   {
+      std::vector<size_t> indices;
+      size_t seed(12345);
+      for(size_t i=0; i<draws; i++)
+      {
+         seed = seed*1103515245+12345;
+         const double u(((seed>>16)&0x7FFF)/32768.0);
+         indices.push_back((size_t)(u*u*u*count));
+      }
+      return indices;
+   }
+
+   void InsertStrings(const std::vector<std::string>& keys, std::vector<String>& strings, size_t)
+   {
+      for(size_t i=0; i<keys.size(); i++)
+         strings.push_back(String(keys[i]));
+   }
+
+   void InsertLegacy(LegacyPool& pool, const std::vector<std::string>& keys, std::vector<LegacyPool::Node*>& nodes, size_t)
+   {
+      for(size_t i=0; i<keys.size(); i++)
+         nodes.push_back(pool.Acquire(keys[i]));
+   }
+
+   void HitStrings(const std::vector<std::string>& keys, const std::vector<size_t>& draws, size_t)
+   {
+      for(size_t i=0; i<draws.size(); i++)
+      {
+         String s(keys[draws[i]]);
+      }
+   }
+
+   void HitLegacy(LegacyPool& pool, const std::vector<std::string>& keys, const std::vector<size_t>& draws, size_t)
+   {
+      for(size_t i=0; i<draws.size(); i++)
+         pool.Release(pool.Acquire(keys[draws[i]]));
+   }
+
+   void ReleaseStrings(std::vector<String>& strings, size_t)
+   {
+      strings.clear();
+   }
+
+   void ReleaseLegacy(LegacyPool& pool, std::vector<LegacyPool::Node*>& nodes, size_t)
+   {
+      for(size_t i=0; i<nodes.size(); i++)
+         pool.Release(nodes[i]);
+      nodes.clear();
+   }
+
+   void Compare(const std::string& name, const std::vector<std::string>& keys)
+   {
+      const std::vector<size_t> draws(Skewed(keys.size(), 1<<20));
+      std::vector<String> strings;
+      strings.reserve(keys.size());
+      LegacyPool* legacy(new LegacyPool);
+      std::vector<LegacyPool::Node*> nodes;
+      nodes.reserve(keys.size());
+
+      double seconds(Benchmark::Run(1, boost::bind(&InsertLegacy, boost::ref(*legacy), boost::cref(keys), boost::ref(nodes), _1)));
+      Benchmark::Report(name+" insert, legacy", 1, keys.size(), seconds);
+      seconds = Benchmark::Run(1, boost::bind(&InsertStrings, boost::cref(keys), boost::ref(strings), _1));
+      Benchmark::Report(name+" insert", 1, keys.size(), seconds);
+
+      seconds = Benchmark::Run(1, boost::bind(&HitLegacy, boost::ref(*legacy), boost::cref(keys), boost::cref(draws), _1));
+      Benchmark::Report(name+" skewed hit, legacy", 1, draws.size(), seconds);
+      seconds = Benchmark::Run(1, boost::bind(&HitStrings, boost::cref(keys), boost::cref(draws), _1));
+      Benchmark::Report(name+" skewed hit", 1, draws.size(), seconds);
+
+      seconds = Benchmark::Run(1, boost::bind(&ReleaseLegacy, boost::ref(*legacy), boost::ref(nodes), _1));
+      Benchmark::Report(name+" release, legacy", 1, keys.size(), seconds);
+      seconds = Benchmark::Run(1, boost::bind(&ReleaseStrings, boost::ref(strings), _1));
+      Benchmark::Report(name+" release", 1, keys.size(), seconds);
+
+      delete legacy;
+   }
+}
+
+int StringInternBenchmark()
+{
+   Benchmark::Title("String intern pool vs legacy factory");
+
+   Compare("identifiers", Identifiers(1<<18));
+   Compare("paths", Paths(1<<18));
+
+   return 0;
+}
@@ -0,0 +1,134 @@
+/**
+ * Copyright (c) 2011 Michel Foucault
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "Benchmark.h"
+
+#include <System/String.h>
+#include <System/StringView.h>
+
+#include <boost/bind.hpp>
+#include <sstream>
+
+using namespace System;
+
+namespace
+{
+   const size_t repeats = 1024;
+
+   // results feed a volatile sink and start offsets vary, so no search is hoisted out of its loop
+   volatile size_t sink;
+
+   // about 1 MB of log lines, the searched patterns only occur at the very end
+   std::string LogText()
+   {
+      std::ostringstream text;
+      for(size_t i=0; text.tellp()<(1<<20); i++)
+         text << "2026-10-17 12:00:" << i%60 << " worker-" << i%8 << " INFO: processed request " << i << " in " << i%97 << "ms\n";
+      text << "2026-10-17 12:01:00 worker-1 ERROR: disk full; giving up\n";
+      return text.str();
+   }
+
+   void StdFindChar(const std::string& text, size_t)
+   {
+      for(size_t i=0; i<repeats; i++)
+         sink = text.find(';', i&7);
+   }
+
+   void IndexOfChar(const String& text, size_t)
+   {
+      for(size_t i=0; i<repeats; i++)
+         sink = text.IndexOf(';', i&7);
+   }
+
+   void StdFind(const std::string& text, const std::string& what, size_t)
+   {
+      for(size_t i=0; i<repeats; i++)
+         sink = text.find(what, i&7);
+   }
+
+   void IndexOf(const String& text, const String& what, size_t)
+   {
+      for(size_t i=0; i<repeats; i++)
+         sink = text.IndexOf(what, i&7);
+   }
+
+   void StdRFindChar(const std::string& text, size_t)
+   {
+      for(size_t i=0; i<repeats; i++)
+         sink = text.rfind('|', text.size()-(i&7));
+   }
+
+   void LastIndexOfChar(const String& text, size_t)
+   {
+      for(size_t i=0; i<repeats; i++)
+         sink = text.LastIndexOf('|');
+   }
+
+   void StdFindFirstOf(const std::string& text, size_t)
+   {
+      for(size_t i=0; i<repeats; i++)
+         sink = text.find_first_of(";|{}", i&7);
+   }
+
+   void IndexOfAny(const String& text, const String& chars, size_t)
+   {
+      for(size_t i=0; i<repeats; i++)
+         sink = text.IndexOfAny(chars, i&7);
+   }
+}
+
+// operations are bytes scanned, Mops/s reads as MB/s
+int StringSearchBenchmark()
+{
+   Benchmark::Title("String search, MB/s");
+
+   const std::string text(LogText());
+   const String string(text);
+   const size_t bytes(text.size()*repeats);
+
+   Benchmark::Report("std::string::find(char)", 1, bytes, Benchmark::Run(1, boost::bind(&StdFindChar, boost::cref(text), _1)));
+   Benchmark::Report("String::IndexOf(char)", 1, bytes, Benchmark::Run(1, boost::bind(&IndexOfChar, boost::cref(string), _1)));
+
+   const std::string shortNeedle("ERROR");
+   Benchmark::Report("std::string::find, 5 chars", 1, bytes, Benchmark::Run(1, boost::bind(&StdFind, boost::cref(text), boost::cref(shortNeedle), _1)));
+   Benchmark::Report("String::IndexOf, 5 chars", 1, bytes, Benchmark::Run(1, boost::bind(&IndexOf, boost::cref(string), String(shortNeedle), _1)));
+
+   const std::string longNeedle("ERROR: disk full; giving up");
+   Benchmark::Report("std::string::find, 27 chars", 1, bytes, Benchmark::Run(1, boost::bind(&StdFind, boost::cref(text), boost::cref(longNeedle), _1)));
+   Benchmark::Report("String::IndexOf, 27 chars", 1, bytes, Benchmark::Run(1, boost::bind(&IndexOf, boost::cref(string), String(longNeedle), _1)));
+
+   // the first character is everywhere, find stops at each one
+   const std::string commonNeedle(" giving up");
+   Benchmark::Report("std::string::find, common first char", 1, bytes, Benchmark::Run(1, boost::bind(&StdFind, boost::cref(text), boost::cref(commonNeedle), _1)));
+   Benchmark::Report("String::IndexOf, common first char", 1, bytes, Benchmark::Run(1, boost::bind(&IndexOf, boost::cref(string), String(commonNeedle), _1)));
+
+   Benchmark::Report("std::string::rfind(char), absent", 1, bytes, Benchmark::Run(1, boost::bind(&StdRFindChar, boost::cref(text), _1)));
+   Benchmark::Report("String::LastIndexOf(char), absent", 1, bytes, Benchmark::Run(1, boost::bind(&LastIndexOfChar, boost::cref(string), _1)));
+
+   Benchmark::Report("std::string::find_first_of, 4 chars", 1, bytes, Benchmark::Run(1, boost::bind(&StdFindFirstOf, boost::cref(text), _1)));
+   Benchmark::Report("String::IndexOfAny, 4 chars", 1, bytes, Benchmark::Run(1, boost::bind(&IndexOfAny, boost::cref(string), String(";|{}"), _1)));
+
+   return 0;
+}
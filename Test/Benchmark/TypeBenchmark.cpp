@@ -0,0 +1,71 @@
+/**
+ * Copyright (c) 2011 Michel Foucault
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "Benchmark.h"
+
+#include <System/Type.h>
+#include <System/Collections/Generic/List.h>
+
+#include <boost/bind.hpp>
+
+using namespace System;
+using namespace System::Collections::Generic;
+
+namespace
+{
+   const size_t iterations = 1<<18;
+
+   void LookupType(const Object& object, size_t)
+   {
+      for(size_t i=0; i<iterations; i++)
+         object.Type();
+   }
+
+   void TypeName(const Object& object, size_t)
+   {
+      for(size_t i=0; i<iterations; i++)
+         object.ToString();
+   }
+}
+
+int TypeBenchmark()
+{
+   Benchmark::Title("Type lookup");
+
+   const List<String> object;
+   for(size_t threads=1; threads<=Benchmark::MaxThreads(); threads*=2)
+   {
+      const double seconds(Benchmark::Run(threads, boost::bind(&LookupType, boost::cref(object), _1)));
+      Benchmark::Report("Object::Type", threads, threads*iterations, seconds);
+   }
+
+   for(size_t threads=1; threads<=Benchmark::MaxThreads(); threads*=2)
+   {
+      const double seconds(Benchmark::Run(threads, boost::bind(&TypeName, boost::cref(object), _1)));
+      Benchmark::Report("Object::ToString", threads, threads*iterations, seconds);
+   }
+
+   return 0;
+}
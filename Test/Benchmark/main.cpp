@@ -0,0 +1,77 @@
+/**
+ * Copyright (c) 2011 Michel Foucault
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "Benchmark.h"
+
+#include <cstring>
+#include <exception>
+#include <iostream>
+
+struct BenchmarkEntry
+{
+   const char* name;
+   int (*run)();
+};
+
+static const BenchmarkEntry benchmarks[] =
+{
+   { "ObjectRef", &ObjectRefBenchmark },
+   { "Handle", &HandleBenchmark },
+   { "Type", &TypeBenchmark },
+   { "String", &StringBenchmark },
+   { "StringIntern", &StringInternBenchmark },
+   { "StringSearch", &StringSearchBenchmark },
+   { "Encoding", &EncodingBenchmark },
+   { "Format", &FormatBenchmark },
+   { "Console", &ConsoleBenchmark },
+   { "Dictionary", &DictionaryBenchmark },
+   { "List", &ListBenchmark },
+   { "Queue", &QueueBenchmark },
+   { "ConcurrentQueue", &ConcurrentQueueBenchmark },
+   { "ConcurrentDictionary", &ConcurrentDictionaryBenchmark },
+};
+
+// Usage: CoreBenchmark [name...], runs every benchmark when no name is given
+int main(int argc, char* argv[])
+{
+   try
+   {
+      for(size_t i=0; i<sizeof(benchmarks)/sizeof(benchmarks[0]); i++)
+      {
+         bool selected(argc<2);
+         for(int arg=1; arg<argc; arg++)
+            selected |= !strcmp(argv[arg], benchmarks[i].name);
+
+         if(selected)
+            benchmarks[i].run();
+      }
+   }
+   catch(std::exception& e)
+   {
+      std::cout << e.what() << std::endl;
+      return 1;
+   }
+   return 0;
+}
@@ -25,13 +25,18 @@
 
 #include <iostream>
 #include <sstream>
+#include <stdexcept>
 #include <list>
 
+#include <boost/thread/thread.hpp>
+
 #include <System.h>
 #include <System/Data.h>
 #include <System/Threading.h>
+#include <System/Text.h>
 #include <System/Collections.h>
 #include <System/Xml/XmlDocument.h>
+#include <System/Diagnostics/Instrumentation.h>
 
 #include "MyWorker.h"
 
@@ -67,31 +72,51 @@ public:
 };
 
 static int TypeTest();
+static int ObjectRefTest();
 static int CollectionTest();
 static int SrtingTest();
 static int XmlTest();
 static int ThreadTest();
+static int PoolTest();
+static int DiagnosticsTest();
 #include <set>
 #include <list>
 #include <map>
 #include <vector>
 #include <algorithm>
 
+// checks print what failed and make the test exit with an error
+static int failures = 0;
+
+static void Expect(bool condition, const char* what)
+{
+   if(!condition)
+   {
+      std::cout << "FAILED: " << what << std::endl;
+      failures++;
+   }
+}
+
 int main(int argc, char* argv[])
 {
    try
    {
+      Diagnostics::Instrumentation::Enable();
       TypeTest();
+      ObjectRefTest();
       CollectionTest();
       SrtingTest();
       XmlTest();
       ThreadTest();
+      PoolTest();
+      DiagnosticsTest();
    }
    catch(std::exception& e)
    {
       std::cout << e.what() << std::endl;
+      failures++;
    }
-   return 0;
+   return failures ? 1 : 0;
 }
 
 typedef std::vector<String> StringCollection;
@@ -107,12 +132,101 @@ static int TypeTest()
    std::cout << "Guid Equals? " << (Guid::Empty()==Guid::Empty()) << std::endl;
 
 
-   Console::WriteLine(String("Hello, "), String("World!"));
+   Console::WriteLine(String("Hello, {0}"), String("World!"));
    Console::WriteLine(String().Type());
    Console::WriteLine(Type::Get<String>());
+   Console::WriteLine(Type::Of<Object>());
+   std::cout << "Type Equals? " << (Type::Of<String>()==String().Type()) << std::endl;
+   return 0;
+}
+
+static int ObjectRefTest()
+{
+   std::cout << "ObjectRef Test" << std::endl;
+   ObjectRef ref(ObjectRef::Make<String>("Hello, World!"));
+   WeakObjectRef weak(ref);
+   Console::WriteLine(weak.Lock().Get<String>());
+
+   ref = ObjectRef();
+   std::cout << "Expired? " << weak.Expired() << " Locked? " << (bool)weak.Lock() << std::endl;
+
+   Collections::Generic::Queue<int> queue;
+   const size_t hashCode(queue.HashCode());
+   Collections::Generic::Queue<int> moved(std::move(queue));
+   std::cout << "Moved HashCode? " << (queue.HashCode()==hashCode) << " " << (moved.HashCode()==hashCode) << std::endl;
+
+   ObjectRef first(ObjectRef::Make<String>("first"));
+   ObjectRef second(ObjectRef::Make<String>("second"));
+   WeakObjectRef firstWeak(first);
+   first = std::move(second);
+   Expect(!second, "moved-from ObjectRef is empty");
+   Expect(firstWeak.Expired(), "move assignment releases the old target");
+
+   String text("old");
+   text = String("new");
+   Expect(text==String("new"), "String move assignment takes the new value");
    return 0;
 }
 
+// every instance hashes alike, only Equals tells them apart
+class CollidingKey : public Object
+{
+public:
+   explicit CollidingKey(int id = 0) : id(id) {}
+
+   size_t HashCode() const { return 42; }
+
+   bool Equals(const Object& other) const
+   {
+      const CollidingKey* key = dynamic_cast<const CollidingKey*>(&other);
+      return key && key->id==id;
+   }
+
+private:
+   int id;
+};
+
+
+// formats on its own while being formatted, through enough formats to reuse every cache slot
+class NestedFormat : public Object
+{
+public:
+   size_t HashCode() const { return 0; }
+
+   std::string ToString() const
+   {
+      StringBuilder builder;
+      for(int i=0; i<256; i++)
+      {
+         std::ostringstream format;
+         format << "{0}/" << i << ";";
+         builder.AppendFormat(String::Transient(format.str()), i);
+      }
+      std::ostringstream length;
+      length << builder.Length();
+      return length.str();
+   }
+};
+
+// writes to the console while being written
+class LoggingObject : public Object
+{
+public:
+   size_t HashCode() const { return 0; }
+
+   std::string ToString() const
+   {
+      Console::WriteLine(String("Logged from ToString: {0}"), 7);
+      return "logging object";
+   }
+};
+
+struct StringJoiner
+{
+   std::string joined;
+   void operator()(String& s) { joined += (std::string)s + ";"; }
+};
+
 static int CollectionTest()
 {
    std::cout << "Collection Test" << std::endl;
@@ -128,6 +242,86 @@ static int CollectionTest()
 
    System::Data::StructuredData structuredData;
 
+   Collections::Generic::Detail::ListStorage<String, false> boxed;
+   Collections::Generic::Detail::ListStorage<String, true> unboxed;
+   for(int i=0; i<100; i++)
+   {
+      std::ostringstream item;
+      item << "item-" << i;
+      boxed.Add(String(item.str()));
+      unboxed.Add(String(item.str()));
+   }
+   boxed.RemoveAt(10);
+   unboxed.RemoveAt(10);
+   StringJoiner boxedJoin, unboxedJoin;
+   boxed.ForEach(boxedJoin);
+   unboxed.ForEach(unboxedJoin);
+   std::cout << "List Backends: " << (boxed.Count()==unboxed.Count()) << " " << (boxed.At(42)==unboxed.At(42))
+             << " " << (boxed.ToArray()==unboxed.ToArray()) << " " << (boxedJoin.joined==unboxedJoin.joined)
+             << " " << (std::string)unboxed.At(10) << std::endl;
+
+   System::Collections::Generic::Dictionary<String, String> dictionary;
+   for(int i=0; i<1000; i++)
+   {
+      std::ostringstream key;
+      key << "key-" << i;
+      dictionary.Add(String(key.str()), String::Transient(key.str()));
+   }
+   dictionary.Remove(String("key-500"));
+   std::cout << "Dictionary: " << dictionary.Count() << " " << dictionary.Contains(String::Transient("key-999"))
+             << " " << dictionary.Contains(String("key-500")) << " " << (std::string)dictionary[String("key-42")] << std::endl;
+
+   System::Collections::Generic::ConcurrentDictionary<String, String> cache;
+   String cached;
+   for(int i=0; i<1000; i++)
+   {
+      std::ostringstream key;
+      key << "key-" << i;
+      cache.TryAdd(String(key.str()), String("value"));
+   }
+   std::cout << "ConcurrentDictionary: " << cache.Count() << " " << (std::string)cache.GetOrAdd(String("key-1"), String("other"))
+             << " " << cache.TryRemove(String("key-2"), cached) << " " << cache.TryGetValue(String("key-2"), cached)
+             << " " << cache.AllKeys().Count() << std::endl;
+
+   System::Collections::Generic::Dictionary<CollidingKey, String> colliding;
+   System::Collections::Generic::ConcurrentDictionary<CollidingKey, String> concurrentColliding;
+   const CollidingKey first(1), second(2);
+   colliding.Add(first, String("first"));
+   colliding.Add(second, String("second"));
+   concurrentColliding.TryAdd(first, String("first"));
+   concurrentColliding.TryAdd(second, String("second"));
+   String found;
+   Expect(colliding.Count()==2 && concurrentColliding.Count()==2, "colliding keys stay distinct");
+   Expect(colliding.Contains(CollidingKey(1)) && (std::string)colliding[CollidingKey(2)]=="second", "Dictionary finds colliding keys");
+   Expect(!colliding.Contains(CollidingKey(3)), "Dictionary tells a third colliding key apart");
+   Expect(concurrentColliding.TryGetValue(CollidingKey(1), found) && (std::string)found=="first"
+          && concurrentColliding.TryGetValue(CollidingKey(2), found) && (std::string)found=="second", "ConcurrentDictionary finds colliding keys");
+   std::cout << "Colliding Keys: " << colliding.Count() << " " << concurrentColliding.Count() << std::endl;
+
+   // Buffer keeps the default Equals: a copy of the handle is the same key
+   const Buffer buffer;
+   System::Collections::Generic::Dictionary<Buffer, String> buffers;
+   System::Collections::Generic::Set<Buffer> bufferSet;
+   buffers.Add(buffer, String("buffer"));
+   bufferSet.Add(buffer);
+   bool duplicate(false);
+   try
+   {
+      bufferSet.Add(Buffer(buffer));
+   }
+   catch(ObjectPresentException&)
+   {
+      duplicate = true;
+   }
+   Expect(buffers.Contains(buffer) && !buffers.Contains(Buffer()), "Dictionary finds a key with the default Equals");
+   Expect(bufferSet.Contains(buffer) && !bufferSet.Contains(Buffer()) && duplicate && bufferSet.Count()==1, "Set finds an element with the default Equals");
+   std::cout << "Default Equals Keys: " << buffers.Count() << " " << bufferSet.Count() << std::endl;
+
+   System::Collections::Generic::Dictionary<Guid, String> guids;
+   const Guid guid(Guid::New());
+   guids.Add(guid, String("guid"));
+   std::cout << "Guid Key: " << guids.Contains(Guid::Parse(guid.ToString())) << " " << guids.Contains(Guid::New()) << std::endl;
+
    return 0;
 }
 
@@ -151,6 +345,64 @@ static int SrtingTest()
 
       //std::cout << strings.back().HashCode() << std::endl;
    }
+
+   const String transient(String("Hello, ") + String("World!"));
+   std::cout << "Interned? " << transient.IsInterned() << " " << transient.Intern().IsInterned() << std::endl;
+   StringBuilder builder(64);
+   builder.Append("Builder: ").Append(String("pi=")).Append(3.14159).Append(", n=").Append(42).Append(' ').Append(Guid::Empty());
+   Console::WriteLine(builder.ToString());
+   std::cout << "Builder Interned? " << builder.ToString().IsInterned() << std::endl;
+
+   const String csv("  alpha, beta,,gamma  ");
+   StringTokens tokens(csv.Trim().Split(String(",")));
+   StringView token;
+   while(tokens.Next(token))
+      std::cout << "[" << token.Trim().ToString() << "]";
+   std::cout << std::endl;
+   std::cout << "Split Count: " << csv.Split(String(",")).ToCollection().Count() << std::endl;
+   Console::WriteLine(csv.Replace(String("a"), String("A")).Remove(String(" ")));
+
+   const String line("2026-10-17 12:00:01 [worker-3] ERROR: disk full on /var/log");
+   std::cout << "IndexOf: " << line.IndexOf(String("ERROR")) << " " << line.LastIndexOf('/')
+             << " " << line.IndexOfAny(String("[]")) << " " << line.Contains(String("warning")) << std::endl;
+
+   std::cout << "Transient Equals? " << (transient==String("Hello, World!"))
+             << " " << (transient.HashCode()==String("Hello, World!").HashCode()) << std::endl;
+
+   // the content hash is part of the format, it must not change between runs or builds
+   const size_t persistedHash(sizeof(size_t)==8 ? (size_t)0xE1D35985A2A679DCULL : transient.HashCode());
+   Collections::Generic::Set<String> set;
+   set.Add(String("Hello, World!"));
+   std::cout << "Content Hash: " << (String("Hello, World!").HashCode()==persistedHash)
+             << " " << (String::Transient("Hello, World!").HashCode()==persistedHash)
+             << " " << set.Contains(transient) << " " << set.Contains(String::Transient("Hello, World?")) << std::endl;
+
+   Console::WriteLine(String("Format: [{0,6}] [{1,-6:X4}] {{{2:N2}}}"), 42, 255, 1234567.891);
+   StringBuilder nested;
+   nested.AppendFormat(String("Nested Format: {0} {1}"), NestedFormat(), 42);
+   Expect((std::string)nested.ToString()=="Nested Format: 1828 42", "formatting nested in an argument's ToString");
+   Console::WriteLine(nested.ToString());
+   Console::WriteLine(String("Nested Write: [{0}] [{1}]"), LoggingObject(), 42);
+   Console::WriteLine(String("Custom Format: [{0:yyyy-MM-dd}] [{1,4:abc}] [{2:}]"), String("2026-10-17"), "x", 7);
+   try
+   {
+      Console::WriteLine(String("{0:yyyy-MM-dd}"), 7);
+   }
+   catch(FormatException&)
+   {
+      std::cout << "Custom Numeric Format: FormatException" << std::endl;
+   }
+   Console::EnableAsync(256, Console::Block);
+   for(int i=0; i<3; i++)
+      Console::WriteLine(String("Async line {0}"), i);
+   Console::Flush();
+   Console::DisableAsync();
+
+   const String utf8("Z\xC3\xBCrich \xF0\x9F\x98\x80");
+   const Buffer utf16(Text::Encoding::ToUtf16(utf8));
+   std::cout << "UTF-8: " << Text::Encoding::IsValidUtf8(utf8) << " " << Text::Encoding::CountCodePoints(utf8)
+             << " " << utf16.Size() << " " << (Text::Encoding::FromUtf16(utf16)==utf8)
+             << " " << Text::Encoding::IsValidUtf8(String("\xED\xA0\x80")) << std::endl;
    return 0;
 }
 
@@ -216,6 +468,152 @@ private:
 
 typedef System::Collections::ForeachIterator<MyWorkerCollection> MyWorkerIterator;
 
+typedef System::Collections::Generic::ConcurrentDictionary<String, int> RaceDictionary;
+
+static const int raceThreads = 4;
+static const int raceKeys = 2000;
+static const int raceShared = 16;
+static const int raceRounds = 500;
+
+static String RaceKey(int thread, int i)
+{
+   std::ostringstream key;
+   key << "race-" << thread << "-" << i;
+   return String::Transient(key.str());
+}
+
+static int Increment(const String&, int value)
+{
+   return value+1;
+}
+
+// Each thread owns its keys and adds, updates and removes them while the table grows; all of them
+// update the same shared keys.
+static void RaceWorker(RaceDictionary dictionary, int thread)
+{
+   for(int i=0; i<raceKeys; i++)
+   {
+      const String key(RaceKey(thread, i));
+      dictionary.TryAdd(key, i);
+      dictionary.AddOrUpdate(key, -1, &Increment);
+      if(i%4==0)
+         dictionary.TryRemove(key);
+
+      if(i<raceRounds)
+      {
+         std::ostringstream shared;
+         shared << "shared-" << i%raceShared;
+         dictionary.AddOrUpdate(String::Transient(shared.str()), 1, &Increment);
+      }
+   }
+}
+
+static void ConcurrentDictionaryRace()
+{
+   RaceDictionary dictionary;
+   boost::thread_group threads;
+   for(int t=0; t<raceThreads; t++)
+      threads.create_thread(boost::bind(&RaceWorker, dictionary, t));
+   threads.join_all();
+
+   bool present(true);
+   int value;
+   for(int t=0; t<raceThreads; t++)
+   {
+      for(int i=0; i<raceKeys; i++)
+      {
+         const bool found(dictionary.TryGetValue(RaceKey(t, i), value));
+         present = present && (i%4==0 ? !found : found && value==i+1);
+      }
+   }
+
+   int sharedTotal(0);
+   for(int i=0; i<raceShared; i++)
+   {
+      std::ostringstream shared;
+      shared << "shared-" << i;
+      if(dictionary.TryGetValue(String(shared.str()), value))
+         sharedTotal += value;
+   }
+
+   const size_t count(dictionary.Count());
+   dictionary.Clear();
+   for(int i=0; i<4 && Memory::Epoch::Pending(); i++)
+      Memory::Epoch::Collect();
+
+   std::cout << "ConcurrentDictionary Race: " << (count==raceThreads*(raceKeys-raceKeys/4)+raceShared) << " " << present
+             << " " << (sharedTotal==raceThreads*raceRounds) << " " << Memory::Epoch::Pending() << std::endl;
+}
+
+class CountingRunnable : public Threading::IRunnable
+{
+public:
+   static boost::atomic<int> runs;
+
+   void Run() { runs++; }
+};
+
+boost::atomic<int> CountingRunnable::runs(0);
+
+static const int startThreads = 4;
+static const int startsPerThread = 50;
+
+static void StartThreads()
+{
+   for(int i=0; i<startsPerThread; i++)
+   {
+      Threading::Thread thread;
+      thread.Start<CountingRunnable>();
+   }
+}
+
+// Thread::Start from several threads at once must neither deadlock nor lose a start
+static void ConcurrentThreadStart()
+{
+   boost::thread_group starters;
+   for(int t=0; t<startThreads; t++)
+      starters.create_thread(&StartThreads);
+   starters.join_all();
+
+   Expect(CountingRunnable::runs==startThreads*startsPerThread, "every concurrently started thread ran");
+   std::cout << "Concurrent Thread Start: " << CountingRunnable::runs << std::endl;
+}
+
+// copies throw on demand, moves never do
+struct FragileItem
+{
+   static bool failCopies;
+
+   FragileItem() {}
+   FragileItem(const FragileItem&) { if(failCopies) throw std::runtime_error("copy"); }
+   FragileItem(FragileItem&&) noexcept {}
+   FragileItem& operator =(const FragileItem&) { return *this; }
+   FragileItem& operator =(FragileItem&&) noexcept { return *this; }
+};
+
+bool FragileItem::failCopies = false;
+
+static void ConcurrentQueueThrowingCopy()
+{
+   System::Collections::Generic::ConcurrentQueue<FragileItem> queue(4);
+   const FragileItem item;
+   FragileItem::failCopies = true;
+   try
+   {
+      queue.TryEnqueue(item);
+   }
+   catch(std::runtime_error&)
+   {
+   }
+   FragileItem::failCopies = false;
+
+   FragileItem out;
+   const bool enqueued(queue.TryEnqueue(item));
+   const bool dequeued(queue.TryDequeue(out));
+   Expect(enqueued && dequeued && queue.Count()==0, "a throwing copy leaves the ring usable");
+   std::cout << "ConcurrentQueue Throwing Copy: " << enqueued << " " << dequeued << std::endl;
+}
+
 static int ThreadTest()
 {
    MyWorker w;
@@ -278,6 +676,23 @@ static int ThreadTest()
    while(!workerQueue.Empty())
       w = workerQueue.Dequeue();
 
+   System::Collections::Generic::Queue<String> stringQueue;
+   std::vector<String> strings(3, String("range"));
+   stringQueue.Enqueue(String("first"));
+   stringQueue.EnqueueRange(strings);
+   String first;
+   std::cout << "Queue: " << (std::string)stringQueue.Peek() << " " << stringQueue.TryDequeue(first)
+             << " " << stringQueue.DequeueRange(strings, 16) << " " << strings.size() << " " << stringQueue.TryDequeue(first) << std::endl;
+
+   System::Collections::Generic::ConcurrentQueue<String> concurrentQueue(2);
+   concurrentQueue.Enqueue(String("first"));
+   std::cout << "ConcurrentQueue: " << concurrentQueue.Capacity() << " " << concurrentQueue.TryEnqueue(String("second"))
+             << " " << concurrentQueue.TryEnqueue(String("third")) << " " << (std::string)concurrentQueue.Dequeue()
+             << " " << concurrentQueue.TryDequeue(first, 10) << " " << concurrentQueue.TryDequeue(first, 10) << std::endl;
+   ConcurrentQueueThrowingCopy();
+   ConcurrentDictionaryRace();
+   ConcurrentThreadStart();
+
    std::cout << "PriorityQueue Test" << std::endl;
    System::Collections::Generic::PriorityQueue<String> priorityQueue;
    for(int i=0; i<6; i++)
@@ -343,3 +758,75 @@ static int ThreadTest()
 
    return 0;
 }
+
+static void* pooledBlock = NULL;
+
+static void PoolAllocate()
+{
+   pooledBlock = Memory::Pool::Allocate(48);
+}
+
+static void PoolRetain(Int64 before, Int64& during)
+{
+   std::vector<void*> blocks;
+   for(int i=0; i<10; i++)
+      blocks.push_back(Memory::Pool::Allocate(64));
+   for(int i=0; i<10; i++)
+      Memory::Pool::Deallocate(blocks[i], 64);
+   during = Memory::Pool::Statistics().BytesRetained-before;
+}
+
+static int PoolTest()
+{
+   std::cout << "Pool Test" << std::endl;
+
+   // sizes round up to a multiple of Granularity, a block serves any size of its class
+   void* block(Memory::Pool::Allocate(1));
+   Memory::Pool::Deallocate(block, 1);
+   void* same(Memory::Pool::Allocate(Memory::Pool::Granularity));
+   void* next(Memory::Pool::Allocate(Memory::Pool::Granularity+1));
+   std::cout << "Size Classes: " << (same==block) << " " << (next!=block) << std::endl;
+   Memory::Pool::Deallocate(same, Memory::Pool::Granularity);
+   Memory::Pool::Deallocate(next, Memory::Pool::Granularity+1);
+
+   // a block freed on another thread than its own goes to the freeing thread's cache
+   boost::thread(&PoolAllocate).join();
+   Memory::Pool::Deallocate(pooledBlock, 48);
+   void* reused(Memory::Pool::Allocate(48));
+   std::cout << "Cross-thread Free: " << (reused==pooledBlock) << std::endl;
+   Memory::Pool::Deallocate(reused, 48);
+
+   // an exiting thread gives its free blocks back
+   const Int64 retained(Memory::Pool::Statistics().BytesRetained);
+   Int64 during(0);
+   boost::thread(boost::bind(&PoolRetain, retained, boost::ref(during))).join();
+   std::cout << "Thread Exit: " << during << " " << Memory::Pool::Statistics().BytesRetained-retained << std::endl;
+
+   const Memory::PoolStatistics before(Diagnostics::Instrumentation::Pool());
+   for(int i=0; i<1000; i++)
+      Memory::Pool::Deallocate(Memory::Pool::Allocate(32), 32);
+   const Memory::PoolStatistics after(Diagnostics::Instrumentation::Pool());
+   std::cout << "Hit Rate: " << after.Allocations-before.Allocations << " " << after.Hits-before.Hits
+             << " " << (after.HitRate()>0) << std::endl;
+   return 0;
+}
+
+static int DiagnosticsTest()
+{
+   std::cout << "Diagnostics Test" << std::endl;
+
+   std::vector<Diagnostics::TypeStatistics> types(Diagnostics::Instrumentation::Types());
+   for(size_t i=0; i<types.size(); i++)
+      std::cout << types[i].Name << ": live " << types[i].Live << ", allocations " << types[i].Allocations
+                << ", reference operations " << types[i].ReferenceOperations << std::endl;
+
+   const Memory::PoolStatistics pool(Diagnostics::Instrumentation::Pool());
+   std::cout << "Pool: allocations " << pool.Allocations << ", hit rate " << pool.HitRate()
+             << ", bytes retained " << pool.BytesRetained << std::endl;
+
+   std::vector<Diagnostics::LockStatistics> locks(Diagnostics::Instrumentation::Locks());
+   for(size_t i=0; i<locks.size(); i++)
+      std::cout << locks[i].Name << ": acquisitions " << locks[i].Acquisitions << ", contentions " << locks[i].Contentions
+                << ", wait " << locks[i].WaitSeconds << "s" << std::endl;
+   return 0;
+}